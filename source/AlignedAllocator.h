@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+namespace dae
+{
+	//std::allocator only guarantees the alignment of the type itself, this one starts every buffer on an alignment boundary
+	//used for data that is laid out in blocks of a cache line, so a block never straddles two lines
+	template<typename T, size_t alignment>
+	struct AlignedAllocator
+	{
+		static_assert(alignment >= alignof(T) && (alignment & (alignment - 1)) == 0, "alignment must be a power of 2 that T allows");
+
+		using value_type = T;
+
+		template<typename U>
+		struct rebind
+		{
+			using other = AlignedAllocator<U, alignment>;
+		};
+
+		AlignedAllocator() = default;
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, alignment>&) {}
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ alignment }));
+		}
+
+		void deallocate(T* pData, size_t)
+		{
+			::operator delete(pData, std::align_val_t{ alignment });
+		}
+
+		template<typename U>
+		bool operator==(const AlignedAllocator<U, alignment>&) const { return true; }
+		template<typename U>
+		bool operator!=(const AlignedAllocator<U, alignment>&) const { return false; }
+	};
+}
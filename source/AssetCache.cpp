@@ -0,0 +1,102 @@
+#include "AssetCache.h"
+#include "AssetLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace dae
+{
+	namespace
+	{
+		template<typename Future>
+		bool IsReady(const Future& future)
+		{
+			return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		template<typename Map>
+		void ReleaseUnusedFrom(Map& assets)
+		{
+			for (auto it{ assets.begin() }; it != assets.end();)
+			{
+				//the future holds the only other reference to the handle
+				if (IsReady(it->second) && it->second.get().use_count() <= 1)
+					it = assets.erase(it);
+				else
+					++it;
+			}
+		}
+
+		template<typename Map>
+		void ReportFrom(const Map& assets, std::vector<AssetCache::AssetInfo>& report)
+		{
+			for (const auto& [key, future] : assets)
+			{
+				if (!IsReady(future) || !future.get())
+					continue;
+
+				report.push_back({ key, future.get()->GetSizeInBytes(), future.get().use_count() - 1 });
+			}
+		}
+	}
+
+	std::shared_future<TextureHandle> AssetCache::RequestTexture(const std::string& path, TextureLayout layout, TextureFormat format)
+	{
+		const std::string key{ GetCanonicalPath(path) + "?layout=" + std::to_string(int(layout)) + "&format=" + std::to_string(int(format)) };
+
+		const std::lock_guard lock{ m_Mutex };
+		auto it{ m_Textures.find(key) };
+		if (it == m_Textures.end())
+			it = m_Textures.emplace(key, AssetLoader::LoadTexture(*m_pJobs, path, layout, format).share()).first;
+
+		return it->second;
+	}
+
+	std::shared_future<GeometryHandle> AssetCache::RequestMesh(const std::string& path)
+	{
+		const std::string key{ GetCanonicalPath(path) };
+
+		const std::lock_guard lock{ m_Mutex };
+		auto it{ m_Meshes.find(key) };
+		if (it == m_Meshes.end())
+			it = m_Meshes.emplace(key, AssetLoader::LoadMesh(*m_pJobs, path).share()).first;
+
+		return it->second;
+	}
+
+	void AssetCache::ReleaseUnused()
+	{
+		const std::lock_guard lock{ m_Mutex };
+		ReleaseUnusedFrom(m_Textures);
+		ReleaseUnusedFrom(m_Meshes);
+	}
+
+	std::vector<AssetCache::AssetInfo> AssetCache::GetMemoryReport() const
+	{
+		std::vector<AssetInfo> report{};
+		{
+			const std::lock_guard lock{ m_Mutex };
+			ReportFrom(m_Textures, report);
+			ReportFrom(m_Meshes, report);
+		}
+
+		std::sort(report.begin(), report.end(), [](const AssetInfo& a, const AssetInfo& b) { return a.sizeInBytes > b.sizeInBytes; });
+		return report;
+	}
+
+	size_t AssetCache::GetTotalSizeInBytes() const
+	{
+		size_t size{};
+		for (const AssetInfo& info : GetMemoryReport())
+			size += info.sizeInBytes;
+		return size;
+	}
+
+	std::string AssetCache::GetCanonicalPath(const std::string& path)
+	{
+		//weakly_canonical also works for files that do not exist, those fail later when they are loaded
+		std::error_code error{};
+		const std::filesystem::path canonical{ std::filesystem::weakly_canonical(path, error) };
+		return error ? path : canonical.generic_string();
+	}
+}
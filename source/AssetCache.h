@@ -0,0 +1,62 @@
+#pragma once
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DataTypes.h"
+#include "JobSystem.h"
+#include "Texture.h"
+
+namespace dae
+{
+	//hands out shared handles to textures and meshes, every file is loaded once however often it is asked for
+	//assets are keyed by their canonical path, so "./Resources/a.png" and "Resources/a.png" are the same asset
+	class AssetCache final
+	{
+	public:
+		explicit AssetCache(JobSystem& jobs) : m_pJobs{ &jobs } {}
+		~AssetCache() = default;
+
+		AssetCache(const AssetCache&) = delete;
+		AssetCache(AssetCache&&) noexcept = delete;
+		AssetCache& operator=(const AssetCache&) = delete;
+		AssetCache& operator=(AssetCache&&) noexcept = delete;
+
+		//the first request schedules the load as a job, later ones get the same future
+		//the layout and format are part of the key, the same file can be cached in several formats
+		std::shared_future<TextureHandle> RequestTexture(const std::string& path, TextureLayout layout = TextureLayout::linear, TextureFormat format = TextureFormat::rgba8);
+		std::shared_future<GeometryHandle> RequestMesh(const std::string& path);
+
+		//wait for the asset if it is still loading
+		TextureHandle GetTexture(const std::string& path, TextureLayout layout = TextureLayout::linear, TextureFormat format = TextureFormat::rgba8)
+		{
+			return RequestTexture(path, layout, format).get();
+		}
+		GeometryHandle GetMesh(const std::string& path) { return RequestMesh(path).get(); }
+
+		//drops every asset nobody but the cache holds a handle to, assets still loading are kept
+		void ReleaseUnused();
+
+		struct AssetInfo
+		{
+			std::string key{};
+			size_t sizeInBytes{};
+			long useCount{}; //handles held outside the cache
+		};
+
+		//loaded assets only, sorted by size, largest first
+		std::vector<AssetInfo> GetMemoryReport() const;
+		size_t GetTotalSizeInBytes() const;
+
+	private:
+		JobSystem* m_pJobs{};
+
+		mutable std::mutex m_Mutex{};
+		std::unordered_map<std::string, std::shared_future<TextureHandle>> m_Textures{};
+		std::unordered_map<std::string, std::shared_future<GeometryHandle>> m_Meshes{};
+
+		static std::string GetCanonicalPath(const std::string& path);
+	};
+}
@@ -0,0 +1,57 @@
+#include "AssetLoader.h"
+#include "MeshSimplifier.h"
+#include "Utils.h"
+#include <exception>
+
+namespace dae
+{
+	namespace
+	{
+		//the job fulfils a promise, the future then works as it did with a thread per asset
+		template<typename Result, typename Function>
+		std::future<Result> ScheduleLoad(JobSystem& jobs, Function load)
+		{
+			const auto pPromise{ std::make_shared<std::promise<Result>>() };
+			std::future<Result> future{ pPromise->get_future() };
+			jobs.Schedule([pPromise, load]()
+				{
+					try
+					{
+						pPromise->set_value(load());
+					}
+					catch (...)
+					{
+						pPromise->set_exception(std::current_exception());
+					}
+				});
+			return future;
+		}
+	}
+
+	namespace AssetLoader
+	{
+		std::future<TextureHandle> LoadTexture(JobSystem& jobs, const std::string& path, TextureLayout layout, TextureFormat format)
+		{
+			return ScheduleLoad<TextureHandle>(jobs, [path, layout, format]()
+				{
+					return TextureHandle{ Texture::LoadFromFile(path, layout, format) };
+				});
+		}
+
+		std::future<GeometryHandle> LoadMesh(JobSystem& jobs, const std::string& path)
+		{
+			return ScheduleLoad<GeometryHandle>(jobs, [path]()
+				{
+					std::vector<Vertex> vertices{};
+					std::vector<uint32_t> indices{};
+					if (!Utils::ParseOBJ(path, vertices, indices))
+						return GeometryHandle{};
+
+					//the parsed buffers are moved into the shared geometry, nothing is copied
+					auto pGeometry{ std::make_shared<MeshGeometry>(std::move(vertices), std::move(indices), PrimitiveTopology::TriangleList) };
+					pGeometry->lods = MeshSimplifier::BuildLODChain(pGeometry->vertices, pGeometry->indices);
+					return GeometryHandle{ pGeometry };
+				});
+		}
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <future>
+#include <string>
+
+#include "DataTypes.h"
+#include "JobSystem.h"
+#include "Texture.h"
+
+namespace dae
+{
+	//every call decodes or parses its asset in a job, get() on the future waits for it
+	//use AssetCache to share assets, these always load the file again
+	namespace AssetLoader
+	{
+		//an empty handle if the file could not be loaded
+		std::future<TextureHandle> LoadTexture(JobSystem& jobs, const std::string& path, TextureLayout layout = TextureLayout::linear, TextureFormat format = TextureFormat::rgba8);
+
+		//parses the OBJ and builds its LOD chain, an empty handle if the file could not be read
+		std::future<GeometryHandle> LoadMesh(JobSystem& jobs, const std::string& path);
+	}
+}
@@ -0,0 +1,155 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <iterator>
+
+namespace dae
+{
+	namespace BlockCompression
+	{
+		namespace
+		{
+			int Channel(uint32_t texel, int channel)
+			{
+				return int((texel >> (8 * channel)) & 0xFF);
+			}
+
+			uint32_t ToRGB565(const float (&color)[3])
+			{
+				const auto quantize{ [](float value, int maxValue)
+					{
+						return uint32_t(std::clamp(int(value / 255.f * maxValue + 0.5f), 0, maxValue));
+					} };
+				return quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 | quantize(color[2], 31);
+			}
+		}
+
+		uint64_t EncodeBC1(const uint32_t (&texels)[16])
+		{
+			//principal axis of the colors, the endpoints are the extremes along it
+			float mean[3]{};
+			for (uint32_t texel : texels)
+				for (int channel{ 0 }; channel < 3; ++channel)
+					mean[channel] += Channel(texel, channel) / 16.f;
+
+			float covariance[3][3]{};
+			for (uint32_t texel : texels)
+			{
+				float offset[3]{};
+				for (int channel{ 0 }; channel < 3; ++channel)
+					offset[channel] = Channel(texel, channel) - mean[channel];
+				for (int row{ 0 }; row < 3; ++row)
+					for (int column{ 0 }; column < 3; ++column)
+						covariance[row][column] += offset[row] * offset[column];
+			}
+
+			//a few power iterations are plenty for a 3x3 matrix
+			float axis[3]{ 1.f, 1.f, 1.f };
+			for (int iteration{ 0 }; iteration < 8; ++iteration)
+			{
+				float next[3]{};
+				for (int row{ 0 }; row < 3; ++row)
+					next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+
+				const float length{ std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) }) };
+				if (length < 1e-6f)
+					break;
+				for (int channel{ 0 }; channel < 3; ++channel)
+					axis[channel] = next[channel] / length;
+			}
+
+			float minProjection{ FLT_MAX };
+			float maxProjection{ -FLT_MAX };
+			for (uint32_t texel : texels)
+			{
+				float projection{};
+				for (int channel{ 0 }; channel < 3; ++channel)
+					projection += (Channel(texel, channel) - mean[channel]) * axis[channel];
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+
+			const float axisSqrLength{ axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] };
+			float minColor[3]{};
+			float maxColor[3]{};
+			for (int channel{ 0 }; channel < 3; ++channel)
+			{
+				minColor[channel] = mean[channel] + axis[channel] * minProjection / axisSqrLength;
+				maxColor[channel] = mean[channel] + axis[channel] * maxProjection / axisSqrLength;
+			}
+
+			uint32_t color0{ ToRGB565(maxColor) };
+			uint32_t color1{ ToRGB565(minColor) };
+			if (color0 < color1)
+				std::swap(color0, color1);
+
+			//equal endpoints -> every index 0 already decodes to the one color
+			const uint64_t endpoints{ uint64_t(color0) | uint64_t(color1) << 16 };
+			if (color0 == color1)
+				return endpoints;
+
+			//the palette comes from the decoder so both sides always agree
+			uint32_t palette[4]{};
+			for (uint64_t index{ 0 }; index < 4; ++index)
+				palette[index] = DecodeBC1(endpoints | index << 32, 0);
+
+			uint64_t block{ endpoints };
+			for (int texelIdx{ 0 }; texelIdx < 16; ++texelIdx)
+			{
+				uint64_t bestIndex{};
+				int bestDistance{ INT_MAX };
+				for (uint64_t index{ 0 }; index < 4; ++index)
+				{
+					int distance{};
+					for (int channel{ 0 }; channel < 3; ++channel)
+					{
+						const int difference{ Channel(texels[texelIdx], channel) - Channel(palette[index], channel) };
+						distance += difference * difference;
+					}
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = index;
+					}
+				}
+				block |= bestIndex << (32 + 2 * texelIdx);
+			}
+			return block;
+		}
+
+		uint64_t EncodeBC4(const uint8_t (&values)[16])
+		{
+			//max first -> 8 value mode
+			const uint8_t value0{ *std::max_element(std::begin(values), std::end(values)) };
+			const uint8_t value1{ *std::min_element(std::begin(values), std::end(values)) };
+
+			const uint64_t endpoints{ uint64_t(value0) | uint64_t(value1) << 8 };
+			if (value0 == value1)
+				return endpoints;
+
+			uint8_t palette[8]{};
+			for (uint64_t index{ 0 }; index < 8; ++index)
+				palette[index] = DecodeBC4(endpoints | index << 16, 0);
+
+			uint64_t block{ endpoints };
+			for (int texelIdx{ 0 }; texelIdx < 16; ++texelIdx)
+			{
+				uint64_t bestIndex{};
+				int bestDistance{ INT_MAX };
+				for (uint64_t index{ 0 }; index < 8; ++index)
+				{
+					const int distance{ std::abs(int(values[texelIdx]) - int(palette[index])) };
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = index;
+					}
+				}
+				block |= bestIndex << (16 + 3 * texelIdx);
+			}
+			return block;
+		}
+	}
+}
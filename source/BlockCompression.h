@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+
+namespace dae
+{
+	//4x4 texel blocks in the layout of the BC1 and BC4 formats, BC5 is two BC4 blocks (red, green)
+	//texels inside a block are numbered row by row, x + 4 * y
+	namespace BlockCompression
+	{
+		//RGB, 2 x RGB565 endpoints + 2 bit indices, 4 bits per texel
+		uint64_t EncodeBC1(const uint32_t (&texels)[16]);
+		//one channel, 2 x 8 bit endpoints + 3 bit indices, 4 bits per texel
+		uint64_t EncodeBC4(const uint8_t (&values)[16]);
+
+		//RGBA8 with red in the lowest byte and alpha 255
+		inline uint32_t DecodeBC1(uint64_t block, int texelIdx)
+		{
+			const uint32_t color0{ uint32_t(block & 0xFFFF) };
+			const uint32_t color1{ uint32_t((block >> 16) & 0xFFFF) };
+			const uint32_t index{ uint32_t(block >> (32 + 2 * texelIdx)) & 3 };
+
+			//565 -> 888, the top bits are repeated in the bottom ones so 31 and 63 map to 255
+			const auto expand{ [](uint32_t color, int channel)
+				{
+					switch (channel)
+					{
+					case 0: { const uint32_t r{ (color >> 11) & 31 }; return (r << 3) | (r >> 2); }
+					case 1: { const uint32_t g{ (color >> 5) & 63 }; return (g << 2) | (g >> 4); }
+					default: { const uint32_t b{ color & 31 }; return (b << 3) | (b >> 2); }
+					}
+				} };
+
+			uint32_t texel{ 0xFF000000 };
+			for (int channel{ 0 }; channel < 3; ++channel)
+			{
+				const uint32_t c0{ expand(color0, channel) };
+				const uint32_t c1{ expand(color1, channel) };
+
+				uint32_t value{};
+				if (color0 > color1)
+				{
+					constexpr uint32_t weights0[4]{ 3, 0, 2, 1 };
+					value = (c0 * weights0[index] + c1 * (3 - weights0[index]) + 1) / 3;
+				}
+				else
+				{
+					//3 color mode, the encoder never writes it but it is valid data
+					constexpr uint32_t weights0[4]{ 2, 0, 1, 0 };
+					value = index == 3 ? 0 : (c0 * weights0[index] + c1 * (2 - weights0[index])) / 2;
+				}
+				texel |= value << (8 * channel);
+			}
+			return texel;
+		}
+
+		//all 4 colors a block can index, the index of texel i is (block >> (32 + 2 * i)) & 3
+		inline void DecodeBC1Palette(uint64_t block, uint32_t (&palette)[4])
+		{
+			const uint32_t color0{ uint32_t(block & 0xFFFF) };
+			const uint32_t color1{ uint32_t((block >> 16) & 0xFFFF) };
+			if (color0 <= color1)
+			{
+				//3 color mode, rare enough to go through the texel decoder
+				for (uint64_t index{ 0 }; index < 4; ++index)
+					palette[index] = DecodeBC1((block & 0xFFFFFFFF) | index << 32, 0);
+				return;
+			}
+
+			//all 3 channels at once, every channel has room for 3 * 255 before it reaches the next one
+			const auto expand{ [](uint32_t color)
+				{
+					const uint32_t r{ (color >> 11) & 31 };
+					const uint32_t g{ (color >> 5) & 63 };
+					const uint32_t b{ color & 31 };
+					return uint64_t((r << 3) | (r >> 2)) | uint64_t((g << 2) | (g >> 4)) << 16 | uint64_t((b << 3) | (b >> 2)) << 32;
+				} };
+			const auto pack{ [](uint64_t channels)
+				{
+					return 0xFF000000 | uint32_t(channels & 0xFF) | uint32_t((channels >> 16) & 0xFF) << 8 | uint32_t((channels >> 32) & 0xFF) << 16;
+				} };
+			const auto third{ [](uint64_t channels)
+				{
+					//(c + 1) / 3 per channel, exact for c up to 3 * 255
+					const uint64_t rounded{ channels + 0x0000000100010001 };
+					return ((rounded & 0xFFFF) * 0xAAAB >> 17) | (((rounded >> 16) & 0xFFFF) * 0xAAAB >> 17) << 16 | (((rounded >> 32) & 0xFFFF) * 0xAAAB >> 17) << 32;
+				} };
+
+			const uint64_t c0{ expand(color0) };
+			const uint64_t c1{ expand(color1) };
+			palette[0] = pack(c0);
+			palette[1] = pack(c1);
+			palette[2] = pack(third(2 * c0 + c1));
+			palette[3] = pack(third(c0 + 2 * c1));
+		}
+
+		inline uint8_t DecodeBC4(uint64_t block, int texelIdx)
+		{
+			const uint32_t value0{ uint32_t(block & 0xFF) };
+			const uint32_t value1{ uint32_t((block >> 8) & 0xFF) };
+			const uint32_t index{ uint32_t(block >> (16 + 3 * texelIdx)) & 7 };
+
+			if (index < 2)
+				return uint8_t(index == 0 ? value0 : value1);
+
+			//8 value mode, 6 interpolated values
+			if (value0 > value1)
+				return uint8_t((value0 * (8 - index) + value1 * (index - 1) + 3) / 7);
+
+			//6 value mode, 4 interpolated values plus 0 and 255
+			if (index >= 6)
+				return index == 6 ? 0 : 255;
+			return uint8_t((value0 * (6 - index) + value1 * (index - 1) + 2) / 5);
+		}
+
+		//all 8 values a block can index, the index of texel i is (block >> (16 + 3 * i)) & 7
+		inline void DecodeBC4Palette(uint64_t block, uint8_t (&palette)[8])
+		{
+			const uint32_t value0{ uint32_t(block & 0xFF) };
+			const uint32_t value1{ uint32_t((block >> 8) & 0xFF) };
+			palette[0] = uint8_t(value0);
+			palette[1] = uint8_t(value1);
+
+			if (value0 > value1)
+			{
+				for (uint32_t index{ 2 }; index < 8; ++index)
+					palette[index] = uint8_t((value0 * (8 - index) + value1 * (index - 1) + 3) / 7);
+				return;
+			}
+
+			for (uint32_t index{ 2 }; index < 6; ++index)
+				palette[index] = uint8_t((value0 * (6 - index) + value1 * (index - 1) + 2) / 5);
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+#include "Math.h"
+
+namespace dae
+{
+	struct BoundingBox
+	{
+		Vector3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+		Vector3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		bool IsValid() const
+		{
+			return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+		}
+
+		Vector3 GetCenter() const
+		{
+			return (min + max) * 0.5f;
+		}
+
+		Vector3 GetExtents() const
+		{
+			return (max - min) * 0.5f;
+		}
+
+		void Grow(const Vector3& point)
+		{
+			min = { std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z) };
+			max = { std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z) };
+		}
+
+		void Grow(const BoundingBox& box)
+		{
+			Grow(box.min);
+			Grow(box.max);
+		}
+
+		//transform the 8 corners without touching them one by one (Arvo, Graphics Gems 1990)
+		BoundingBox Transformed(const Matrix& matrix) const
+		{
+			const Vector3 translation{ matrix.GetTranslation() };
+			BoundingBox out{ translation, translation };
+
+			for (int row{ 0 }; row < 3; ++row)
+			{
+				const Vector4 axis{ matrix[row] };
+				for (int col{ 0 }; col < 3; ++col)
+				{
+					const float a{ axis[col] * min[row] };
+					const float b{ axis[col] * max[row] };
+					out.min[col] += std::min(a, b);
+					out.max[col] += std::max(a, b);
+				}
+			}
+			return out;
+		}
+
+		template<typename VertexType>
+		static BoundingBox FromVertices(const std::vector<VertexType>& vertices)
+		{
+			BoundingBox box{};
+			for (const auto& vertex : vertices)
+				box.Grow(vertex.position);
+			return box;
+		}
+	};
+
+	enum class Containment
+	{
+		outside, intersecting, inside
+	};
+
+	struct Frustum
+	{
+		//plane = (normal, distance), points inside have Dot(normal, p) + distance >= 0
+		Vector4 planes[6]{};
+
+		//Gribb & Hartmann plane extraction for the row-vector (p * M) convention, z in [0, 1]
+		static Frustum FromMatrix(const Matrix& viewProjection)
+		{
+			const Vector4 column0{ viewProjection[0].x, viewProjection[1].x, viewProjection[2].x, viewProjection[3].x };
+			const Vector4 column1{ viewProjection[0].y, viewProjection[1].y, viewProjection[2].y, viewProjection[3].y };
+			const Vector4 column2{ viewProjection[0].z, viewProjection[1].z, viewProjection[2].z, viewProjection[3].z };
+			const Vector4 column3{ viewProjection[0].w, viewProjection[1].w, viewProjection[2].w, viewProjection[3].w };
+
+			Frustum frustum{};
+			frustum.planes[0] = column3 + column0; //left
+			frustum.planes[1] = column3 - column0; //right
+			frustum.planes[2] = column3 + column1; //bottom
+			frustum.planes[3] = column3 - column1; //top
+			frustum.planes[4] = column2;           //near
+			frustum.planes[5] = column3 - column2; //far
+
+			for (auto& plane : frustum.planes)
+			{
+				const float length{ Vector3{ plane }.Magnitude() };
+				plane = plane * (1.f / length);
+			}
+			return frustum;
+		}
+
+		Containment Test(const BoundingBox& box) const
+		{
+			const Vector3 center{ box.GetCenter() };
+			const Vector3 extents{ box.GetExtents() };
+
+			Containment result{ Containment::inside };
+			for (const auto& plane : planes)
+			{
+				const float distance{ plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w };
+				const float radius{ std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z };
+
+				if (distance < -radius)
+					return Containment::outside;
+				if (distance < radius)
+					result = Containment::intersecting;
+			}
+			return result;
+		}
+	};
+}
@@ -3,6 +3,7 @@
 #include <SDL_keyboard.h>
 #include <SDL_mouse.h>
 
+#include "Bounds.h"
 #include "Math.h"
 #include "Timer.h"
 
@@ -62,6 +63,11 @@ namespace dae
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixperspectivefovlh
 		}
 
+		Frustum GetFrustum() const
+		{
+			return Frustum::FromMatrix(viewMatrix * projectionMatrix);
+		}
+
 		void Update(Timer* pTimer)
 		{
 			const float deltaTime = pTimer->GetElapsed();
@@ -1,6 +1,9 @@
 #pragma once
+#include "Bounds.h"
 #include "Math.h"
 #include "vector"
+#include <cstdint>
+#include <memory>
 
 namespace dae
 {
@@ -30,6 +33,14 @@ namespace dae
 		TriangleStrip
 	};
 
+	//simplified version of a mesh, always a triangle list
+	struct MeshLOD
+	{
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> indices{};
+		float error{}; //object space distance to the full mesh
+	};
+
 	struct Mesh
 	{
 		std::vector<Vertex> vertices{};
@@ -39,4 +50,55 @@ namespace dae
 		std::vector<Vertex_Out> vertices_out{};
 		Matrix worldMatrix{};
 	};
+
+	//vertex data that is loaded once and shared (read only) by every instance that draws it
+	struct MeshGeometry
+	{
+		MeshGeometry(std::vector<Vertex>&& _vertices, std::vector<uint32_t>&& _indices, PrimitiveTopology _primitiveTopology) :
+			vertices{ std::move(_vertices) },
+			indices{ std::move(_indices) },
+			primitiveTopology{ _primitiveTopology },
+			bounds{ BoundingBox::FromVertices(vertices) }
+		{
+		}
+
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> indices{};
+		PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleList };
+
+		BoundingBox bounds{}; //object space
+
+		//lods[0] is the first simplified level, lodIdx 0 means the full mesh
+		std::vector<MeshLOD> lods{};
+
+		const std::vector<Vertex>& GetLODVertices(int lodIdx) const
+		{
+			return lodIdx == 0 ? vertices : lods[lodIdx - 1].vertices;
+		}
+
+		const std::vector<uint32_t>& GetLODIndices(int lodIdx) const
+		{
+			return lodIdx == 0 ? indices : lods[lodIdx - 1].indices;
+		}
+
+		//vertex and index buffers of every level
+		size_t GetSizeInBytes() const
+		{
+			size_t size{ vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t) };
+			for (const MeshLOD& lod : lods)
+				size += lod.vertices.size() * sizeof(Vertex) + lod.indices.size() * sizeof(uint32_t);
+			return size;
+		}
+	};
+
+	using GeometryHandle = std::shared_ptr<const MeshGeometry>;
+
+	//per object state, the geometry itself is never copied
+	struct MeshInstance
+	{
+		GeometryHandle pGeometry{};
+		Matrix worldMatrix{};
+		int lodIdx{};
+		size_t objectId{ SIZE_MAX }; //in the scene, to find the instance again in the next frame, SIZE_MAX when drawn outside of it
+	};
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "GBuffer.h"
+#include "JobSystem.h"
+#include "Material.h"
+#include "Math.h"
+#include "PhongShader.h"
+#include "Pipeline.h"
+#include "Sampler.h"
+
+namespace dae
+{
+	//geometry pass, the material and the normal of the nearest surface go to the g-buffer, nothing is lit yet
+	template<bool isUsingNormalMap, bool isShowingTexture>
+	struct PhongGBufferPixelShader
+	{
+		using Varyings = PhongVaryings<isUsingNormalMap, false>;
+
+		const Material* pMaterial{};
+		SamplerState sampler{};
+		GBuffer* pGBuffer{};
+
+		void ShadeQuad(const PixelQuad<Varyings>& quad) const
+		{
+			const Vector2 uvs[4]{ quad.varyings[0].uv, quad.varyings[1].uv, quad.varyings[2].uv, quad.varyings[3].uv };
+			const Vector2 uvDdx{ uvs[1] - uvs[0] };
+			const Vector2 uvDdy{ uvs[2] - uvs[0] };
+			MaterialSample materialSamples[4]{};
+			pMaterial->SampleQuad(sampler, uvs, uvDdx, uvDdy, materialSamples);
+
+			for (int lane{ 0 }; lane < 4; ++lane)
+			{
+				if (!quad.isVisible[lane])
+					continue;
+
+				const Varyings& pixel{ quad.varyings[lane] };
+				const MaterialSample& material{ materialSamples[lane] };
+
+				Vector3 normal{ pixel.normal };
+				if constexpr (isUsingNormalMap)
+				{
+					const Vector3 binormal{ Vector3::Cross(normal, pixel.tangent) };
+					const Matrix tangentSpaceAxis{ Matrix{pixel.tangent, binormal, normal, Vector3::Zero} };
+					normal = tangentSpaceAxis.TransformVector(material.normal);
+				}
+
+				//without the texture the lighting pass takes the color from the depth plane, like the forward shader
+				const int currentPixel{ quad.x + (lane & 1) + (quad.y + (lane >> 1)) * pGBuffer->GetWidth() };
+				if constexpr (isShowingTexture)
+					pGBuffer->GetAlbedo()[currentPixel] = GBuffer::PackAlbedo(material.diffuse);
+				pGBuffer->GetNormals()[currentPixel] = GBuffer::PackNormal(normal);
+				pGBuffer->GetMaterials()[currentPixel] = GBuffer::PackMaterial(material.specular, material.gloss);
+			}
+		}
+	};
+
+	//lighting pass, every pixel the geometry pass wrote is shaded once, the cleared ones keep what the target holds
+	//the screen is split in tiles whose g-buffer and pixels fit in the l1 cache together, each one a job
+	template<ShadingMode shadingMode, bool isShowingTexture, bool isUsingLocalLights, bool isUsingShadows>
+	void ShadeGBuffer(JobSystem& jobs, const GBuffer& gBuffer, const PhongLighting<shadingMode, isUsingLocalLights, isUsingShadows>& lighting,
+		const Matrix& invViewMatrix, const Matrix& projectionMatrix, const RenderTarget& target)
+	{
+		using Lighting = PhongLighting<shadingMode, isUsingLocalLights, isUsingShadows>;
+
+		constexpr int tileSize{ 32 }; //32 x 32 x (14 + 4) bytes, a multiple of the light grid tiles
+		const int width{ gBuffer.GetWidth() };
+		const int height{ gBuffer.GetHeight() };
+		const int tilesX{ (width + tileSize - 1) / tileSize };
+		const int tileCount{ tilesX * ((height + tileSize - 1) / tileSize) };
+
+		//ndc x = p00 * x / z and ndc z = a + b / z, the world position is rebuilt from the depth with it
+		const float p00{ projectionMatrix[0][0] };
+		const float p11{ projectionMatrix[1][1] };
+		const float a{ projectionMatrix[2][2] };
+		const float b{ projectionMatrix[3][2] };
+
+		const auto shadeTile{ [&](int tileIdx)
+			{
+				const int minX{ (tileIdx % tilesX) * tileSize };
+				const int minY{ (tileIdx / tilesX) * tileSize };
+				const int maxX{ std::min(minX + tileSize, width) };
+				const int maxY{ std::min(minY + tileSize, height) };
+
+				for (int y{ minY }; y < maxY; ++y)
+				{
+					const float ndcY{ 1.f - 2.f * y / height };
+
+					//4 pixels of a row at a time, they share the specular power evaluation and a light grid tile
+					for (int x{ minX }; x < maxX; x += 4)
+					{
+						PhongSurfaces surfaces{};
+						bool isAnyActive{ false };
+						for (int lane{ 0 }; lane < 4; ++lane)
+						{
+							const int px{ x + lane };
+							if (px >= maxX)
+								break;
+
+							const int currentPixel{ px + y * width };
+							const float depth{ gBuffer.GetDepth()[currentPixel] };
+							if (depth >= 1.f)
+								continue;
+
+							const float ndcX{ 2.f * px / width - 1.f };
+							if constexpr (isUsingLocalLights || isUsingShadows)
+							{
+								const float viewZ{ b / (depth - a) };
+								surfaces.positions[lane] = invViewMatrix.TransformPoint(Vector3{ ndcX * viewZ / p00, ndcY * viewZ / p11, viewZ });
+							}
+
+							if constexpr (Lighting::isUsingColor && isShowingTexture)
+								surfaces.colors[lane] = GBuffer::UnpackAlbedo(gBuffer.GetAlbedo()[currentPixel]);
+							else if constexpr (Lighting::isUsingColor)
+							{
+								const float remapped{ Remap(depth, 0.985f, 1.f) };
+								surfaces.colors[lane] = { remapped, remapped, remapped };
+							}
+
+							float gloss{};
+							GBuffer::UnpackMaterial(gBuffer.GetMaterials()[currentPixel], surfaces.speculars[lane], gloss);
+							surfaces.exponents[lane] = gloss * lighting.constants.shininess;
+							surfaces.normals[lane] = GBuffer::UnpackNormal(gBuffer.GetNormals()[currentPixel]);
+
+							//the same direction the forward vertex shader computes, per pixel instead of per vertex
+							surfaces.viewDirections[lane] = (lighting.constants.cameraOrigin - Vector3{ ndcX, ndcY, depth }).Normalized();
+							surfaces.isActive[lane] = true;
+							isAnyActive = true;
+						}
+
+						if (!isAnyActive)
+							continue;
+
+						ColorRGB colors[4]{};
+						lighting.Shade(surfaces, x, y, colors);
+
+						for (int lane{ 0 }; lane < 4; ++lane)
+						{
+							if (surfaces.isActive[lane])
+								target.pColors->Write(x + lane + y * width, colors[lane]);
+						}
+					}
+				}
+			} };
+
+		//a job per tile, the calling thread shades tiles too while it waits for the rest
+		jobs.ParallelFor(tileCount, 1, [&](int firstTile, int lastTile)
+			{
+				for (int tileIdx{ firstTile }; tileIdx < lastTile; ++tileIdx)
+					shadeTile(tileIdx);
+			});
+	}
+}
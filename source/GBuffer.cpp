@@ -0,0 +1,33 @@
+#include "GBuffer.h"
+#include <cfloat>
+
+namespace dae
+{
+	GBuffer::GBuffer(int width, int height) :
+		m_Width{ width },
+		m_Height{ height },
+		m_Albedo(size_t(width) * height),
+		m_Normals(size_t(width) * height),
+		m_Materials(size_t(width) * height),
+		m_Depth(size_t(width) * height, FLT_MAX)
+	{
+	}
+
+	void GBuffer::Resize(int width, int height)
+	{
+		if (width == m_Width && height == m_Height)
+			return;
+
+		m_Width = width;
+		m_Height = height;
+		m_Albedo.resize(size_t(width) * height);
+		m_Normals.resize(size_t(width) * height);
+		m_Materials.resize(size_t(width) * height);
+		m_Depth.resize(size_t(width) * height, FLT_MAX);
+	}
+
+	void GBuffer::Clear()
+	{
+		std::fill(m_Depth.begin(), m_Depth.end(), FLT_MAX);
+	}
+}
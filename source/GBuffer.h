@@ -0,0 +1,106 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+
+namespace dae
+{
+	//what the geometry pass of deferred shading leaves for the lighting pass, one plane per attribute
+	//a pixel is 14 bytes: albedo rgb8 in 4 bytes (the fourth is unused), normal as 2 snorm16 (octahedral), specular and gloss unorm8, depth float
+	class GBuffer final
+	{
+	public:
+		GBuffer(int width, int height);
+		~GBuffer() = default;
+
+		GBuffer(const GBuffer&) = delete;
+		GBuffer(GBuffer&&) noexcept = delete;
+		GBuffer& operator=(const GBuffer&) = delete;
+		GBuffer& operator=(GBuffer&&) noexcept = delete;
+
+		//the contents are undefined afterwards, memory is only allocated when it grows past anything it was before
+		void Resize(int width, int height);
+
+		//only the depth is reset, it tells which pixels the other planes hold anything for
+		void Clear();
+
+		int GetWidth() const { return m_Width; }
+		int GetHeight() const { return m_Height; }
+
+		uint32_t* GetAlbedo() { return m_Albedo.data(); }
+		uint32_t* GetNormals() { return m_Normals.data(); }
+		uint16_t* GetMaterials() { return m_Materials.data(); }
+		float* GetDepth() { return m_Depth.data(); }
+		const uint32_t* GetAlbedo() const { return m_Albedo.data(); }
+		const uint32_t* GetNormals() const { return m_Normals.data(); }
+		const uint16_t* GetMaterials() const { return m_Materials.data(); }
+		const float* GetDepth() const { return m_Depth.data(); }
+
+		//red in the lowest byte, the top byte stays 0
+		static uint32_t PackAlbedo(const ColorRGB& color)
+		{
+			return uint32_t(Saturate(color.r) * 255.f + 0.5f) | uint32_t(Saturate(color.g) * 255.f + 0.5f) << 8 |
+				uint32_t(Saturate(color.b) * 255.f + 0.5f) << 16;
+		}
+
+		static ColorRGB UnpackAlbedo(uint32_t albedo)
+		{
+			constexpr float scale{ 1.f / 255.f };
+			return { (albedo & 0xff) * scale, (albedo >> 8 & 0xff) * scale, (albedo >> 16 & 0xff) * scale };
+		}
+
+		//the normal projected on an octahedron and the octahedron unfolded into a square, 2 values instead of 3
+		static uint32_t PackNormal(const Vector3& normal)
+		{
+			const float invLength{ 1.f / (fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z)) };
+			float x{ normal.x * invLength };
+			float y{ normal.y * invLength };
+			if (normal.z < 0.f)
+			{
+				//the lower half folds over the diagonals
+				const float foldedX{ (1.f - fabsf(y)) * (x >= 0.f ? 1.f : -1.f) };
+				const float foldedY{ (1.f - fabsf(x)) * (y >= 0.f ? 1.f : -1.f) };
+				x = foldedX;
+				y = foldedY;
+			}
+			return uint32_t(uint16_t(int16_t(lroundf(x * 32767.f)))) | uint32_t(uint16_t(int16_t(lroundf(y * 32767.f)))) << 16;
+		}
+
+		static Vector3 UnpackNormal(uint32_t packed)
+		{
+			constexpr float scale{ 1.f / 32767.f };
+			const float x{ int16_t(packed & 0xffff) * scale };
+			const float y{ int16_t(packed >> 16) * scale };
+
+			Vector3 normal{ x, y, 1.f - fabsf(x) - fabsf(y) };
+			const float fold{ std::max(-normal.z, 0.f) };
+			normal.x += normal.x >= 0.f ? -fold : fold;
+			normal.y += normal.y >= 0.f ? -fold : fold;
+			return normal.Normalized();
+		}
+
+		static uint16_t PackMaterial(float specular, float gloss)
+		{
+			return uint16_t(uint32_t(Saturate(specular) * 255.f + 0.5f) | uint32_t(Saturate(gloss) * 255.f + 0.5f) << 8);
+		}
+
+		static void UnpackMaterial(uint16_t material, float& specular, float& gloss)
+		{
+			constexpr float scale{ 1.f / 255.f };
+			specular = (material & 0xff) * scale;
+			gloss = (material >> 8) * scale;
+		}
+
+	private:
+		int m_Width{};
+		int m_Height{};
+
+		std::vector<uint32_t> m_Albedo{};
+		std::vector<uint32_t> m_Normals{};
+		std::vector<uint16_t> m_Materials{};
+		std::vector<float> m_Depth{};
+	};
+}
@@ -0,0 +1,220 @@
+#include "HDRBuffer.h"
+#include <algorithm>
+#include <emmintrin.h>
+
+#include "MathHelpers.h"
+
+namespace dae
+{
+	HDRBuffer::HDRBuffer(int width, int height) :
+		m_Width{ width },
+		m_Height{ height },
+		//rounded up to whole blocks of 4, the resolve never needs a scalar tail for the loads
+		m_Red((size_t(width) * height + 3) & ~size_t(3)),
+		m_Green((size_t(width) * height + 3) & ~size_t(3)),
+		m_Blue((size_t(width) * height + 3) & ~size_t(3))
+	{
+	}
+
+	void HDRBuffer::Resize(int width, int height, int sampleCount)
+	{
+		if (width == m_Width && height == m_Height && sampleCount == m_SampleCount)
+			return;
+
+		m_Width = width;
+		m_Height = height;
+		m_SampleCount = sampleCount;
+		m_Red.resize((size_t(width) * height + 3) & ~size_t(3));
+		m_Green.resize((size_t(width) * height + 3) & ~size_t(3));
+		m_Blue.resize((size_t(width) * height + 3) & ~size_t(3));
+
+		//the extra samples are kept when going back to 1, they are only read while multisampled
+		if (sampleCount > 1)
+		{
+			m_SampleRed.resize(GetPlaneSize() * (sampleCount - 1));
+			m_SampleGreen.resize(GetPlaneSize() * (sampleCount - 1));
+			m_SampleBlue.resize(GetPlaneSize() * (sampleCount - 1));
+			m_IsEdge.resize(GetPlaneSize());
+		}
+	}
+
+	void HDRBuffer::Clear(const ColorRGB& color)
+	{
+		std::fill(m_Red.begin(), m_Red.end(), color.r);
+		std::fill(m_Green.begin(), m_Green.end(), color.g);
+		std::fill(m_Blue.begin(), m_Blue.end(), color.b);
+
+		if (m_SampleCount > 1)
+			std::fill(m_IsEdge.begin(), m_IsEdge.end(), uint8_t(false));
+	}
+
+	void HDRBuffer::WriteSamples(int pixel, uint32_t sampleMask, const ColorRGB& color)
+	{
+		const size_t planeSize{ GetPlaneSize() };
+
+		//the first partial write splits the pixel, every sample starts out with the color it had
+		if (!m_IsEdge[pixel])
+		{
+			for (int sample{ 1 }; sample < m_SampleCount; ++sample)
+			{
+				const size_t sampleIdx{ (sample - 1) * planeSize + pixel };
+				m_SampleRed[sampleIdx] = m_Red[pixel];
+				m_SampleGreen[sampleIdx] = m_Green[pixel];
+				m_SampleBlue[sampleIdx] = m_Blue[pixel];
+			}
+			m_IsEdge[pixel] = true;
+		}
+
+		if (sampleMask & 1)
+			Write(pixel, color);
+		for (int sample{ 1 }; sample < m_SampleCount; ++sample)
+		{
+			if (!(sampleMask & (1u << sample)))
+				continue;
+
+			const size_t sampleIdx{ (sample - 1) * planeSize + pixel };
+			m_SampleRed[sampleIdx] = color.r;
+			m_SampleGreen[sampleIdx] = color.g;
+			m_SampleBlue[sampleIdx] = color.b;
+		}
+	}
+
+	void HDRBuffer::Resolve(JobSystem& jobs, uint32_t* pPixels, const PixelFormat& format, const ToneMapping& toneMapping) const
+	{
+		if (m_SampleCount > 1)
+			return Resolve<true>(jobs, pPixels, format, toneMapping);
+		return Resolve<false>(jobs, pPixels, format, toneMapping);
+	}
+
+	template<bool isMultisampled>
+	void HDRBuffer::Resolve(JobSystem& jobs, uint32_t* pPixels, const PixelFormat& format, const ToneMapping& toneMapping) const
+	{
+		//a gamma of 1 is skipped, the approximated pow would not give the value back exactly
+		const bool isApplyingGamma{ toneMapping.gamma != 1.f };
+		switch (toneMapping.tonemapOperator)
+		{
+		case ToneMappingOperator::maxToOne:
+			return isApplyingGamma ? Resolve<ToneMappingOperator::maxToOne, true, isMultisampled>(jobs, pPixels, format, toneMapping) :
+				Resolve<ToneMappingOperator::maxToOne, false, isMultisampled>(jobs, pPixels, format, toneMapping);
+		case ToneMappingOperator::reinhard:
+			return isApplyingGamma ? Resolve<ToneMappingOperator::reinhard, true, isMultisampled>(jobs, pPixels, format, toneMapping) :
+				Resolve<ToneMappingOperator::reinhard, false, isMultisampled>(jobs, pPixels, format, toneMapping);
+		case ToneMappingOperator::aces:
+			return isApplyingGamma ? Resolve<ToneMappingOperator::aces, true, isMultisampled>(jobs, pPixels, format, toneMapping) :
+				Resolve<ToneMappingOperator::aces, false, isMultisampled>(jobs, pPixels, format, toneMapping);
+		}
+	}
+
+	template<ToneMappingOperator tonemapOperator, bool isApplyingGamma, bool isMultisampled>
+	void HDRBuffer::Resolve(JobSystem& jobs, uint32_t* pPixels, const PixelFormat& format, const ToneMapping& toneMapping) const
+	{
+		const __m128 exposure{ _mm_set1_ps(toneMapping.exposure) };
+		const __m128 inverseGamma{ _mm_set1_ps(1.f / toneMapping.gamma) };
+		const __m128 zero{ _mm_setzero_ps() };
+		const __m128 one{ _mm_set1_ps(1.f) };
+
+		const auto tonemap{ [&](__m128& red, __m128& green, __m128& blue)
+			{
+				red = _mm_mul_ps(red, exposure);
+				green = _mm_mul_ps(green, exposure);
+				blue = _mm_mul_ps(blue, exposure);
+
+				if constexpr (tonemapOperator == ToneMappingOperator::maxToOne)
+				{
+					//the channels over 1 are divided by the brightest one, the rest by 1 so they stay exactly as they are
+					const __m128 maxValue{ _mm_max_ps(red, _mm_max_ps(green, blue)) };
+					const __m128 isAboveOne{ _mm_cmpgt_ps(maxValue, one) };
+					const __m128 divisor{ _mm_or_ps(_mm_and_ps(isAboveOne, maxValue), _mm_andnot_ps(isAboveOne, one)) };
+					red = _mm_div_ps(red, divisor);
+					green = _mm_div_ps(green, divisor);
+					blue = _mm_div_ps(blue, divisor);
+				}
+				else
+				{
+					const auto curve{ [&](__m128 x)
+						{
+							if constexpr (tonemapOperator == ToneMappingOperator::reinhard)
+								return _mm_div_ps(x, _mm_add_ps(one, x));
+							else
+							{
+								//(x * (2.51 x + 0.03)) / (x * (2.43 x + 0.59) + 0.14)
+								const __m128 numerator{ _mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(2.51f)), _mm_set1_ps(0.03f))) };
+								const __m128 denominator{ _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(2.43f)), _mm_set1_ps(0.59f))), _mm_set1_ps(0.14f)) };
+								return _mm_min_ps(_mm_div_ps(numerator, denominator), one);
+							}
+						} };
+					red = curve(_mm_max_ps(red, zero));
+					green = curve(_mm_max_ps(green, zero));
+					blue = curve(_mm_max_ps(blue, zero));
+				}
+			} };
+
+		const auto applyGamma{ [&](__m128& red, __m128& green, __m128& blue)
+			{
+				if constexpr (isApplyingGamma)
+				{
+					red = FastPow(red, inverseGamma);
+					green = FastPow(green, inverseGamma);
+					blue = FastPow(blue, inverseGamma);
+				}
+			} };
+
+		//the samples of the edge pixels in a block of 4 are tonemapped one by one and averaged, a bright sample cannot take over the whole pixel
+		//blocks without an edge pixel are resolved like a single sample buffer
+		const size_t planeSize{ GetPlaneSize() };
+		const auto resolveSamples{ [&](int pixel, __m128& red, __m128& green, __m128& blue)
+			{
+				const uint8_t* pIsEdge{ m_IsEdge.data() + pixel };
+				if ((pIsEdge[0] | pIsEdge[1] | pIsEdge[2] | pIsEdge[3]) == 0)
+					return;
+
+				__m128 redSum{ red };
+				__m128 greenSum{ green };
+				__m128 blueSum{ blue };
+				for (int sample{ 1 }; sample < m_SampleCount; ++sample)
+				{
+					const size_t sampleIdx{ (sample - 1) * planeSize + pixel };
+					__m128 sampleRed{ _mm_loadu_ps(m_SampleRed.data() + sampleIdx) };
+					__m128 sampleGreen{ _mm_loadu_ps(m_SampleGreen.data() + sampleIdx) };
+					__m128 sampleBlue{ _mm_loadu_ps(m_SampleBlue.data() + sampleIdx) };
+					tonemap(sampleRed, sampleGreen, sampleBlue);
+					redSum = _mm_add_ps(redSum, sampleRed);
+					greenSum = _mm_add_ps(greenSum, sampleGreen);
+					blueSum = _mm_add_ps(blueSum, sampleBlue);
+				}
+
+				const __m128 sampleWeight{ _mm_set1_ps(1.f / m_SampleCount) };
+				const __m128 isEdge{ _mm_cmpneq_ps(_mm_set_ps(pIsEdge[3], pIsEdge[2], pIsEdge[1], pIsEdge[0]), zero) };
+				red = _mm_or_ps(_mm_and_ps(isEdge, _mm_mul_ps(redSum, sampleWeight)), _mm_andnot_ps(isEdge, red));
+				green = _mm_or_ps(_mm_and_ps(isEdge, _mm_mul_ps(greenSum, sampleWeight)), _mm_andnot_ps(isEdge, green));
+				blue = _mm_or_ps(_mm_and_ps(isEdge, _mm_mul_ps(blueSum, sampleWeight)), _mm_andnot_ps(isEdge, blue));
+			} };
+
+		//batches start on a multiple of 4, only the last one can end in a partial block
+		const int pixelCount{ m_Width * m_Height };
+		jobs.ParallelFor(pixelCount, resolveBatchSize, [&](int begin, int end)
+			{
+				for (int pixel{ begin }; pixel < end; pixel += 4)
+				{
+					__m128 red{ _mm_loadu_ps(m_Red.data() + pixel) };
+					__m128 green{ _mm_loadu_ps(m_Green.data() + pixel) };
+					__m128 blue{ _mm_loadu_ps(m_Blue.data() + pixel) };
+					tonemap(red, green, blue);
+					if constexpr (isMultisampled)
+						resolveSamples(pixel, red, green, blue);
+					applyGamma(red, green, blue);
+
+					const __m128i packed{ format.Pack(red, green, blue) };
+					if (pixel + 4 <= pixelCount)
+					{
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(pPixels + pixel), packed);
+						continue;
+					}
+
+					alignas(16) uint32_t pixels[4]{};
+					_mm_store_si128(reinterpret_cast<__m128i*>(pixels), packed);
+					std::copy(pixels, pixels + (pixelCount - pixel), pPixels + pixel);
+				}
+			});
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "ColorRGB.h"
+#include "JobSystem.h"
+#include "PixelFormat.h"
+
+namespace dae
+{
+	enum class ToneMappingOperator
+	{
+		maxToOne, //scales a color down by its brightest channel, what every pixel shader used to do
+		reinhard, //c / (1 + c) per channel
+		aces      //filmic curve, Narkowicz's fit of the aces reference transform
+	};
+
+	struct ToneMapping
+	{
+		ToneMappingOperator tonemapOperator{ ToneMappingOperator::maxToOne };
+		float exposure{ 1.f };
+		float gamma{ 1.f }; //1 writes the tonemapped value as it is
+	};
+
+	//the linear colors of the frame, shaders write them unclamped and the resolve turns them into back buffer pixels once
+	//one plane per channel, the resolve then works on 4 pixels per load
+	//with 4 samples a pixel keeps one color until a triangle edge splits it, only then are the other 3 samples stored and resolved
+	class HDRBuffer final
+	{
+	public:
+		HDRBuffer(int width, int height);
+		~HDRBuffer() = default;
+
+		HDRBuffer(const HDRBuffer&) = delete;
+		HDRBuffer(HDRBuffer&&) noexcept = delete;
+		HDRBuffer& operator=(const HDRBuffer&) = delete;
+		HDRBuffer& operator=(HDRBuffer&&) noexcept = delete;
+
+		//the contents are undefined afterwards, memory is only allocated when it grows past anything it was before
+		//1 or multiSampleCount samples per pixel
+		void Resize(int width, int height, int sampleCount = 1);
+
+		void Clear(const ColorRGB& color);
+
+		void Write(int pixel, const ColorRGB& color)
+		{
+			m_Red[pixel] = color.r;
+			m_Green[pixel] = color.g;
+			m_Blue[pixel] = color.b;
+		}
+
+		//multisampled only, every sample of the pixel, it is one color again afterwards
+		void WriteCovered(int pixel, const ColorRGB& color)
+		{
+			Write(pixel, color);
+			m_IsEdge[pixel] = false;
+		}
+
+		//multisampled only, the samples of sampleMask, bit i is sample i
+		void WriteSamples(int pixel, uint32_t sampleMask, const ColorRGB& color);
+
+		//tonemap, gamma and pack every pixel into the back buffer, a job per resolveBatchSize pixels
+		//an edge pixel is the average of its tonemapped samples
+		void Resolve(JobSystem& jobs, uint32_t* pPixels, const PixelFormat& format, const ToneMapping& toneMapping) const;
+
+		int GetWidth() const { return m_Width; }
+		int GetHeight() const { return m_Height; }
+		int GetSampleCount() const { return m_SampleCount; }
+
+		static constexpr int multiSampleCount{ 4 };
+
+	private:
+		int m_Width{};
+		int m_Height{};
+		int m_SampleCount{ 1 };
+
+		//sample 0, or the color of the whole pixel when it is not an edge
+		std::vector<float> m_Red{};
+		std::vector<float> m_Green{};
+		std::vector<float> m_Blue{};
+
+		//samples 1 to 3 one plane after the other, with the size of the planes above, only valid for edge pixels
+		std::vector<float> m_SampleRed{};
+		std::vector<float> m_SampleGreen{};
+		std::vector<float> m_SampleBlue{};
+		std::vector<uint8_t> m_IsEdge{}; //per pixel, rounded up like the planes so the resolve reads 4 at once
+
+		static constexpr int resolveBatchSize{ 16 * 1024 }; //pixels, a multiple of 4
+
+		size_t GetPlaneSize() const { return m_Red.size(); }
+
+		template<bool isMultisampled>
+		void Resolve(JobSystem& jobs, uint32_t* pPixels, const PixelFormat& format, const ToneMapping& toneMapping) const;
+		template<ToneMappingOperator tonemapOperator, bool isApplyingGamma, bool isMultisampled>
+		void Resolve(JobSystem& jobs, uint32_t* pPixels, const PixelFormat& format, const ToneMapping& toneMapping) const;
+	};
+}
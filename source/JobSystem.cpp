@@ -0,0 +1,181 @@
+#include "JobSystem.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		//which system the calling thread works for and which deque is its own, -1 outside every pool
+		thread_local const JobSystem* t_pJobSystem{};
+		thread_local int t_WorkerIdx{ -1 };
+
+		void PinToHardwareThread(std::thread& thread, int hardwareThreadIdx)
+		{
+#if defined(_WIN32)
+			SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (hardwareThreadIdx % 64));
+#elif defined(__linux__)
+			cpu_set_t cpus{};
+			CPU_ZERO(&cpus);
+			CPU_SET(hardwareThreadIdx % CPU_SETSIZE, &cpus);
+			pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#else
+			(void)thread;
+			(void)hardwareThreadIdx;
+#endif
+		}
+	}
+
+	JobSystem::JobSystem(int workerCount, bool isPinningWorkers)
+	{
+		const int hardwareThreadCount{ int(std::max(1u, std::thread::hardware_concurrency())) };
+		if (workerCount <= 0)
+			workerCount = hardwareThreadCount - 1;
+
+		//at least one worker, jobs that are only waited on through a future still get to run
+		workerCount = std::max(1, workerCount);
+
+		for (int queueIdx{ 0 }; queueIdx <= workerCount; ++queueIdx)
+			m_Queues.push_back(std::make_unique<WorkQueue>());
+
+		for (int workerIdx{ 0 }; workerIdx < workerCount; ++workerIdx)
+		{
+			m_Workers.emplace_back(&JobSystem::RunWorker, this, workerIdx);
+			if (isPinningWorkers)
+				PinToHardwareThread(m_Workers.back(), (workerIdx + 1) % hardwareThreadCount);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard lock{ m_SleepMutex };
+			m_IsStopping = true;
+		}
+		m_WakeUp.notify_all();
+
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	JobHandle JobSystem::Create(std::function<void()> function, const JobHandle& pParent)
+	{
+		JobHandle pJob{ std::make_shared<Job>() };
+		pJob->function = std::move(function);
+		pJob->pParent = pParent;
+		if (pParent)
+			pParent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+		return pJob;
+	}
+
+	void JobSystem::Schedule(const JobHandle& pJob)
+	{
+		WorkQueue& queue{ *m_Queues[GetQueueIdx()] };
+		{
+			std::lock_guard lock{ queue.mutex };
+			queue.jobs.push_back(pJob);
+		}
+
+		//taking the sleep mutex orders the count with a worker that is about to go to sleep
+		m_QueuedJobs.fetch_add(1, std::memory_order_release);
+		{
+			std::lock_guard lock{ m_SleepMutex };
+		}
+		m_WakeUp.notify_one();
+	}
+
+	void JobSystem::Wait(const JobHandle& pJob)
+	{
+		while (!IsDone(pJob))
+		{
+			if (const JobHandle pOther{ FindJob() })
+				Execute(pOther);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::RunWorker(int workerIdx)
+	{
+		t_pJobSystem = this;
+		t_WorkerIdx = workerIdx;
+
+		while (true)
+		{
+			if (const JobHandle pJob{ FindJob() })
+			{
+				Execute(pJob);
+				continue;
+			}
+
+			//the queues are only left behind once they are empty
+			std::unique_lock lock{ m_SleepMutex };
+			m_WakeUp.wait(lock, [this]() { return m_QueuedJobs.load(std::memory_order_acquire) > 0 || m_IsStopping; });
+			if (m_IsStopping && m_QueuedJobs.load(std::memory_order_acquire) == 0)
+				return;
+		}
+	}
+
+	JobHandle JobSystem::FindJob()
+	{
+		if (m_QueuedJobs.load(std::memory_order_acquire) == 0)
+			return {};
+
+		//the newest job of the own deque, its data is most likely still in the cache
+		const int ownQueueIdx{ GetQueueIdx() };
+		{
+			WorkQueue& queue{ *m_Queues[ownQueueIdx] };
+			std::lock_guard lock{ queue.mutex };
+			if (!queue.jobs.empty())
+			{
+				JobHandle pJob{ std::move(queue.jobs.back()) };
+				queue.jobs.pop_back();
+				m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				return pJob;
+			}
+		}
+
+		//steal the oldest job of another deque, that tends to be the largest piece of work left
+		const int queueCount{ int(m_Queues.size()) };
+		for (int offset{ 1 }; offset < queueCount; ++offset)
+		{
+			WorkQueue& queue{ *m_Queues[(ownQueueIdx + offset) % queueCount] };
+			std::lock_guard lock{ queue.mutex };
+			if (!queue.jobs.empty())
+			{
+				JobHandle pJob{ std::move(queue.jobs.front()) };
+				queue.jobs.pop_front();
+				m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				return pJob;
+			}
+		}
+		return {};
+	}
+
+	void JobSystem::Execute(const JobHandle& pJob)
+	{
+		pJob->function();
+		pJob->function = nullptr; //releases what it captured before anyone waiting on the job goes on
+		Finish(pJob.get());
+	}
+
+	void JobSystem::Finish(Job* pJob)
+	{
+		//the last of a job and its children to finish finishes the parent
+		//a parent stays alive through the pParent of its children
+		while (pJob && pJob->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			pJob = pJob->pParent.get();
+	}
+
+	int JobSystem::GetQueueIdx() const
+	{
+		return t_pJobSystem == this ? t_WorkerIdx + 1 : 0;
+	}
+}
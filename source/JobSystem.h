@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	//a unit of work, it is done once its function and every child created under it have run
+	struct Job
+	{
+		std::function<void()> function{};
+		std::shared_ptr<Job> pParent{};
+		std::atomic<int> unfinishedJobs{ 1 }; //itself and its children
+	};
+	using JobHandle = std::shared_ptr<Job>;
+
+	//work-stealing scheduler, every worker has a deque of its own
+	//a worker pushes and pops at the back of its deque, so it keeps working on what it just split off, idle workers steal from the front of the others
+	//threads outside the pool share one extra deque, and a thread that waits on a job runs other jobs meanwhile
+	class JobSystem final
+	{
+	public:
+		//0 workers takes one per hardware thread but the one that creates the system, there is always at least one
+		//pinning ties worker i to hardware thread i + 1, the os can then no longer move them around
+		explicit JobSystem(int workerCount = 0, bool isPinningWorkers = false);
+		~JobSystem(); //runs the jobs that are still queued, then stops the workers
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem(JobSystem&&) noexcept = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+		JobSystem& operator=(JobSystem&&) noexcept = delete;
+
+		//a job with a parent keeps that parent from being done until the child has run
+		//children have to be created before the parent is done, from the parent itself or before it is scheduled
+		JobHandle Create(std::function<void()> function, const JobHandle& pParent = {});
+		void Schedule(const JobHandle& pJob);
+		JobHandle Schedule(std::function<void()> function, const JobHandle& pParent = {})
+		{
+			JobHandle pJob{ Create(std::move(function), pParent) };
+			Schedule(pJob);
+			return pJob;
+		}
+
+		//runs other jobs until this one is done, an empty handle is done
+		void Wait(const JobHandle& pJob);
+		static bool IsDone(const JobHandle& pJob) { return !pJob || pJob->unfinishedJobs.load(std::memory_order_acquire) == 0; }
+
+		//function(begin, end) over [0, count) in batches of batchSize, returns when every batch has run
+		template<typename Function>
+		void ParallelFor(int count, int batchSize, const Function& function);
+
+		int GetWorkerCount() const { return int(m_Workers.size()); }
+
+	private:
+		struct WorkQueue
+		{
+			std::mutex mutex{};
+			std::deque<JobHandle> jobs{};
+		};
+
+		//deque 0 is shared by the threads outside the pool, worker i owns deque i + 1
+		std::vector<std::unique_ptr<WorkQueue>> m_Queues{};
+		std::vector<std::thread> m_Workers{};
+
+		//idle workers sleep until something is queued
+		std::atomic<int> m_QueuedJobs{};
+		std::atomic<bool> m_IsStopping{ false };
+		std::mutex m_SleepMutex{};
+		std::condition_variable m_WakeUp{};
+
+		void RunWorker(int workerIdx);
+
+		//the next job for the calling thread, its own newest one first, then the oldest one of another deque
+		JobHandle FindJob();
+		void Execute(const JobHandle& pJob);
+		static void Finish(Job* pJob);
+
+		int GetQueueIdx() const;
+	};
+
+	template<typename Function>
+	void JobSystem::ParallelFor(int count, int batchSize, const Function& function)
+	{
+		if (count <= 0)
+			return;
+
+		//a single batch is not worth a job
+		batchSize = std::max(1, batchSize);
+		if (count <= batchSize)
+		{
+			function(0, count);
+			return;
+		}
+
+		//every batch is a child of one root, waiting on the root waits for all of them
+		const JobHandle pRoot{ Create([]() {}) };
+		for (int begin{ 0 }; begin < count; begin += batchSize)
+		{
+			const int end{ std::min(begin + batchSize, count) };
+			Schedule([&function, begin, end]() { function(begin, end); }, pRoot);
+		}
+		Schedule(pRoot);
+		Wait(pRoot);
+	}
+}
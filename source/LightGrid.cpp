@@ -0,0 +1,121 @@
+#include "LightGrid.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace dae
+{
+	void LightGrid::Build(const std::vector<Light>& lights, const float* pDepth, int width, int height, int sampleCount,
+		const Matrix& viewMatrix, const Matrix& projectionMatrix)
+	{
+		m_pLights = &lights;
+		m_TilesX = (width + tileSize - 1) / tileSize;
+		m_TilesY = (height + tileSize - 1) / tileSize;
+		m_TileOffsets.assign(size_t(m_TilesX) * m_TilesY + 1, 0);
+		m_LightIndices.clear();
+		m_OccupiedTileCount = 0;
+
+		m_ViewSpaceBounds.resize(lights.size());
+		for (size_t lightIdx{ 0 }; lightIdx < lights.size(); ++lightIdx)
+		{
+			const Light& light{ lights[lightIdx] };
+			BoundingSphere sphere{ light.position, light.range };
+			if (light.type == LightType::spot)
+			{
+				//the smallest sphere around the cone, a wide cone is held by its cap, a narrow one by tip and rim
+				const float cosAngle{ light.cosOuterAngle };
+				if (cosAngle < 0.70710678f)
+				{
+					sphere.center = light.position + light.direction * (light.range * cosAngle);
+					sphere.radius = light.range * sqrtf(1.f - cosAngle * cosAngle);
+				}
+				else
+				{
+					sphere.radius = light.range / (2.f * cosAngle);
+					sphere.center = light.position + light.direction * sphere.radius;
+				}
+			}
+			sphere.center = viewMatrix.TransformPoint(sphere.center);
+			m_ViewSpaceBounds[lightIdx] = sphere;
+		}
+
+		//ndc x = p00 * x / z and ndc z = a + b / z for this projection, everything below goes back to view space with it
+		const float p00{ projectionMatrix[0][0] };
+		const float p11{ projectionMatrix[1][1] };
+		const float a{ projectionMatrix[2][2] };
+		const float b{ projectionMatrix[3][2] };
+
+		for (int tileY{ 0 }; tileY < m_TilesY; ++tileY)
+		{
+			for (int tileX{ 0 }; tileX < m_TilesX; ++tileX)
+			{
+				const int tileIdx{ tileX + tileY * m_TilesX };
+				m_TileOffsets[tileIdx + 1] = m_TileOffsets[tileIdx];
+
+				const int minX{ tileX * tileSize };
+				const int minY{ tileY * tileSize };
+				const int maxX{ std::min(minX + tileSize, width) };
+				const int maxY{ std::min(minY + tileSize, height) };
+
+				//depth bounds of the geometry in the tile over all samples, the cleared samples do not count
+				float minDepth{ FLT_MAX };
+				float maxDepth{ -FLT_MAX };
+				for (int sample{ 0 }; sample < sampleCount; ++sample)
+				{
+					const float* pPlane{ pDepth + size_t(sample) * width * height };
+					for (int y{ minY }; y < maxY; ++y)
+					{
+						for (int x{ minX }; x < maxX; ++x)
+						{
+							const float depth{ pPlane[x + y * width] };
+							if (depth >= 1.f)
+								continue;
+							minDepth = std::min(minDepth, depth);
+							maxDepth = std::max(maxDepth, depth);
+						}
+					}
+				}
+				if (minDepth > maxDepth)
+					continue;
+				++m_OccupiedTileCount;
+
+				const float minZ{ b / (minDepth - a) };
+				const float maxZ{ b / (maxDepth - a) };
+
+				//the 4 side planes go through the camera, inside is Dot(plane, p) >= 0
+				const float leftX{ (2.f * minX / width - 1.f) / p00 };
+				const float rightX{ (2.f * maxX / width - 1.f) / p00 };
+				const float topY{ (1.f - 2.f * minY / height) / p11 };
+				const float bottomY{ (1.f - 2.f * maxY / height) / p11 };
+				const Vector3 planes[4]{
+					Vector3{ 1.f, 0.f, -leftX }.Normalized(),
+					Vector3{ -1.f, 0.f, rightX }.Normalized(),
+					Vector3{ 0.f, -1.f, topY }.Normalized(),
+					Vector3{ 0.f, 1.f, -bottomY }.Normalized()
+				};
+
+				for (size_t lightIdx{ 0 }; lightIdx < m_ViewSpaceBounds.size(); ++lightIdx)
+				{
+					const BoundingSphere& sphere{ m_ViewSpaceBounds[lightIdx] };
+					if (sphere.center.z + sphere.radius < minZ || sphere.center.z - sphere.radius > maxZ)
+						continue;
+
+					const bool isOutside{ std::any_of(std::begin(planes), std::end(planes), [&sphere](const Vector3& plane)
+						{
+							return Vector3::Dot(plane, sphere.center) < -sphere.radius;
+						}) };
+					if (isOutside)
+						continue;
+
+					m_LightIndices.push_back(uint32_t(lightIdx));
+					++m_TileOffsets[tileIdx + 1];
+				}
+			}
+		}
+	}
+
+	float LightGrid::GetAverageLightsPerTile() const
+	{
+		return m_OccupiedTileCount > 0 ? float(m_LightIndices.size()) / m_OccupiedTileCount : 0.f;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Math.h"
+
+namespace dae
+{
+	enum class LightType
+	{
+		point,
+		spot
+	};
+
+	//a local light, it reaches nothing beyond its range
+	struct Light
+	{
+		LightType type{ LightType::point };
+		Vector3 position{};
+		Vector3 direction{ Vector3::UnitZ }; //spot only, normalized
+		ColorRGB color{ 1.f, 1.f, 1.f };
+		float intensity{ 1.f };
+		float range{ 10.f };
+		float cosOuterAngle{ 0.8f }; //spot only, the cone fades out between the inner and the outer angle
+		float cosInnerAngle{ 0.9f };
+	};
+
+	//the screen split in tiles, every tile lists the lights whose volume reaches the depth range of its pixels
+	//the depth buffer has to be filled first (depth prepass), tiles without geometry get no lights at all
+	class LightGrid final
+	{
+	public:
+		static constexpr int tileSize{ 16 }; //pixels, a multiple of 8 so a quad never straddles two tiles, also the 8x8 one of 4x4 coarse shading
+
+		LightGrid() = default;
+		~LightGrid() = default;
+
+		LightGrid(const LightGrid&) = delete;
+		LightGrid(LightGrid&&) noexcept = delete;
+		LightGrid& operator=(const LightGrid&) = delete;
+		LightGrid& operator=(LightGrid&&) noexcept = delete;
+
+		//depth holds ndc depth, FLT_MAX where nothing was drawn, one width x height plane per sample
+		//the depth bounds of a tile cover every sample, so a light that only reaches an edge sample is not dropped
+		void Build(const std::vector<Light>& lights, const float* pDepth, int width, int height, int sampleCount,
+			const Matrix& viewMatrix, const Matrix& projectionMatrix);
+
+		//indices into the lights of the last Build, for the tile that holds pixel x, y
+		std::span<const uint32_t> GetTileLights(int x, int y) const
+		{
+			const int tileIdx{ (x / tileSize) + (y / tileSize) * m_TilesX };
+			return { m_LightIndices.data() + m_TileOffsets[tileIdx], m_LightIndices.data() + m_TileOffsets[tileIdx + 1] };
+		}
+
+		//the lights as they were passed to Build
+		const std::vector<Light>& GetLights() const { return *m_pLights; }
+
+		//average over the tiles that hold geometry
+		float GetAverageLightsPerTile() const;
+
+	private:
+		const std::vector<Light>* m_pLights{};
+
+		int m_TilesX{};
+		int m_TilesY{};
+
+		//the lights of tile i are m_LightIndices[m_TileOffsets[i], m_TileOffsets[i + 1])
+		std::vector<uint32_t> m_TileOffsets{};
+		std::vector<uint32_t> m_LightIndices{};
+		int m_OccupiedTileCount{};
+
+		//a sphere around every light volume, in view space
+		struct BoundingSphere
+		{
+			Vector3 center{};
+			float radius{};
+		};
+		std::vector<BoundingSphere> m_ViewSpaceBounds{};
+	};
+}
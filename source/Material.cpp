@@ -0,0 +1,277 @@
+#include "Material.h"
+#include "Texture.h"
+#include "Vector2.h"
+
+namespace dae
+{
+	namespace
+	{
+		//4 texels -> the 7 channels in [0, 1]
+		template<typename Texel>
+		void UnpackQuad(const Texel (&texels)[4], __m128 (&channels)[7])
+		{
+			const __m128i diffuseSpecular{ _mm_setr_epi32(int(texels[0].diffuseSpecular), int(texels[1].diffuseSpecular), int(texels[2].diffuseSpecular), int(texels[3].diffuseSpecular)) };
+			const __m128i normalGloss{ _mm_setr_epi32(int(texels[0].normalGloss), int(texels[1].normalGloss), int(texels[2].normalGloss), int(texels[3].normalGloss)) };
+
+			channels[0] = Sampling::UnpackChannel(diffuseSpecular, 0);
+			channels[1] = Sampling::UnpackChannel(diffuseSpecular, 8);
+			channels[2] = Sampling::UnpackChannel(diffuseSpecular, 16);
+			channels[3] = Sampling::UnpackChannel(diffuseSpecular, 24);
+			channels[4] = Sampling::UnpackChannel(normalGloss, 0);
+			channels[5] = Sampling::UnpackChannel(normalGloss, 8);
+			channels[6] = Sampling::UnpackChannel(normalGloss, 16);
+		}
+	}
+
+	Material::Material(int width, int height) :
+		m_Width{ width },
+		m_Height{ height },
+		m_Texels(size_t(width) * height)
+	{
+	}
+
+	Material* Material::Bake(const Texture& diffuse, const Texture& normal, const Texture& specular, const Texture& gloss, MaterialFormat format)
+	{
+		Material* pMaterial{ new Material(diffuse.GetWidth(), diffuse.GetHeight()) };
+
+		//nearest texel of a map that can have another resolution than the diffuse map
+		const auto fetch{ [pMaterial](const Texture& texture, int x, int y)
+			{
+				return texture.GetTexel(x * texture.GetWidth() / pMaterial->m_Width, y * texture.GetHeight() / pMaterial->m_Height);
+			} };
+
+		for (int y{ 0 }; y < pMaterial->m_Height; ++y)
+		{
+			for (int x{ 0 }; x < pMaterial->m_Width; ++x)
+			{
+				const uint32_t diffuseTexel{ fetch(diffuse, x, y) };
+				const uint32_t normalTexel{ fetch(normal, x, y) };
+				const uint32_t specularTexel{ fetch(specular, x, y) };
+				const uint32_t glossTexel{ fetch(gloss, x, y) };
+
+				Texel& texel{ pMaterial->m_Texels[x + size_t(y) * pMaterial->m_Width] };
+				texel.diffuseSpecular = (diffuseTexel & 0xFFFFFF) | (specularTexel & 0xFF) << 24;
+				texel.normalGloss = (normalTexel & 0xFFFF) | (glossTexel & 0xFF) << 16;
+			}
+		}
+
+		pMaterial->BuildMipChain();
+		if (format == MaterialFormat::blockCompressed)
+			pMaterial->Compress();
+
+		return pMaterial;
+	}
+
+	void Material::BuildMipChain()
+	{
+		//count the levels first so the texel storage is only allocated once
+		size_t texelCount{};
+		for (int width{ m_Width }, height{ m_Height };; width = std::max(1, width / 2), height = std::max(1, height / 2))
+		{
+			m_MipLevels.push_back({ width, height, texelCount });
+			texelCount += size_t(width) * height;
+			if (width == 1 && height == 1)
+				break;
+		}
+		m_Texels.resize(texelCount);
+
+		//box filter every level down from the previous one, the normal is averaged encoded like the separate map was
+		for (size_t mipIdx{ 1 }; mipIdx < m_MipLevels.size(); ++mipIdx)
+		{
+			const MipLevel& source{ m_MipLevels[mipIdx - 1] };
+			const MipLevel& target{ m_MipLevels[mipIdx] };
+			const Texel* pSource{ &m_Texels[source.offset] };
+			Texel* pTarget{ &m_Texels[target.offset] };
+
+			for (int y{ 0 }; y < target.height; ++y)
+			{
+				const int y0{ std::min(2 * y, source.height - 1) };
+				const int y1{ std::min(2 * y + 1, source.height - 1) };
+				for (int x{ 0 }; x < target.width; ++x)
+				{
+					const int x0{ std::min(2 * x, source.width - 1) };
+					const int x1{ std::min(2 * x + 1, source.width - 1) };
+					const Texel& t0{ pSource[x0 + y0 * source.width] };
+					const Texel& t1{ pSource[x1 + y0 * source.width] };
+					const Texel& t2{ pSource[x0 + y1 * source.width] };
+					const Texel& t3{ pSource[x1 + y1 * source.width] };
+
+					Texel& texel{ pTarget[x + y * target.width] };
+					texel.diffuseSpecular = Sampling::Average(t0.diffuseSpecular, t1.diffuseSpecular, t2.diffuseSpecular, t3.diffuseSpecular);
+					texel.normalGloss = Sampling::Average(t0.normalGloss, t1.normalGloss, t2.normalGloss, t3.normalGloss);
+				}
+			}
+		}
+	}
+
+	void Material::Compress()
+	{
+		std::vector<MipLevel> blockLevels{};
+		size_t blockCount{};
+		for (const MipLevel& mip : m_MipLevels)
+		{
+			const int blocksPerRow{ (mip.width + 3) / 4 };
+			blockLevels.push_back({ mip.width, mip.height, blockCount, blocksPerRow });
+			blockCount += size_t(blocksPerRow) * ((mip.height + 3) / 4);
+		}
+		m_Blocks.resize(blockCount);
+
+		for (size_t mipIdx{ 0 }; mipIdx < m_MipLevels.size(); ++mipIdx)
+		{
+			const MipLevel& packedMip{ m_MipLevels[mipIdx] };
+			const MipLevel& blockMip{ blockLevels[mipIdx] };
+			const int blockRows{ (packedMip.height + 3) / 4 };
+
+			for (int blockY{ 0 }; blockY < blockRows; ++blockY)
+			{
+				for (int blockX{ 0 }; blockX < blockMip.blocksPerRow; ++blockX)
+				{
+					//blocks hanging over the edge repeat the edge texels
+					uint32_t diffuse[16]{};
+					uint8_t specular[16]{};
+					uint8_t normalX[16]{};
+					uint8_t normalY[16]{};
+					uint8_t gloss[16]{};
+					for (int texelIdx{ 0 }; texelIdx < 16; ++texelIdx)
+					{
+						const int x{ std::min(blockX * 4 + (texelIdx & 3), packedMip.width - 1) };
+						const int y{ std::min(blockY * 4 + (texelIdx >> 2), packedMip.height - 1) };
+						const Texel& texel{ m_Texels[packedMip.offset + x + size_t(y) * packedMip.width] };
+
+						diffuse[texelIdx] = texel.diffuseSpecular & 0xFFFFFF;
+						specular[texelIdx] = uint8_t(texel.diffuseSpecular >> 24);
+						normalX[texelIdx] = uint8_t(texel.normalGloss & 0xFF);
+						normalY[texelIdx] = uint8_t((texel.normalGloss >> 8) & 0xFF);
+						gloss[texelIdx] = uint8_t((texel.normalGloss >> 16) & 0xFF);
+					}
+
+					Block& block{ m_Blocks[blockMip.offset + size_t(blockY) * blockMip.blocksPerRow + blockX] };
+					block.diffuse = BlockCompression::EncodeBC1(diffuse);
+					block.specular = BlockCompression::EncodeBC4(specular);
+					block.normalX = BlockCompression::EncodeBC4(normalX);
+					block.normalY = BlockCompression::EncodeBC4(normalY);
+					block.gloss = BlockCompression::EncodeBC4(gloss);
+				}
+			}
+		}
+
+		m_Texels.clear();
+		m_Texels.shrink_to_fit();
+		m_MipLevels = std::move(blockLevels);
+		m_Format = MaterialFormat::blockCompressed;
+	}
+
+	void Material::DecodeBlock(const Block& block, DecodedBlock& decoded)
+	{
+		decoded.pBlock = &block;
+		BlockCompression::DecodeBC1Palette(block.diffuse, decoded.diffuse);
+		BlockCompression::DecodeBC4Palette(block.specular, decoded.specular);
+		BlockCompression::DecodeBC4Palette(block.normalX, decoded.normalX);
+		BlockCompression::DecodeBC4Palette(block.normalY, decoded.normalY);
+		BlockCompression::DecodeBC4Palette(block.gloss, decoded.gloss);
+	}
+
+	void Material::SampleQuad(const SamplerState& sampler, const Vector2 (&uvs)[4], const Vector2& uvDdx, const Vector2& uvDdy, MaterialSample (&samples)[4]) const
+	{
+		const __m128 u{ _mm_setr_ps(uvs[0].x, uvs[1].x, uvs[2].x, uvs[3].x) };
+		const __m128 v{ _mm_setr_ps(uvs[0].y, uvs[1].y, uvs[2].y, uvs[3].y) };
+
+		QuadChannels channels{};
+		switch (sampler.filter)
+		{
+		case TextureFilter::point:
+			SamplePointQuad(u, v, sampler.addressMode, channels);
+			break;
+		case TextureFilter::bilinear:
+			SampleBilinearQuad(u, v, 0, sampler.addressMode, channels);
+			break;
+		case TextureFilter::trilinear:
+		{
+			const float lod{ Sampling::GetMipLevel(uvDdx, uvDdy, m_Width, m_Height, GetMipCount()) };
+			const int mipIdx{ int(lod) };
+			const float blend{ lod - float(mipIdx) };
+
+			SampleBilinearQuad(u, v, mipIdx, sampler.addressMode, channels);
+			if (blend > 0.f)
+			{
+				QuadChannels nextChannels{};
+				SampleBilinearQuad(u, v, mipIdx + 1, sampler.addressMode, nextChannels);
+
+				const __m128 blendV{ _mm_set1_ps(blend) };
+				for (int channel{ 0 }; channel < m_ChannelCount; ++channel)
+					channels[channel] = _mm_add_ps(channels[channel], _mm_mul_ps(_mm_sub_ps(nextChannels[channel], channels[channel]), blendV));
+			}
+			break;
+		}
+		}
+
+		//[0, 1] -> [-1, 1], z follows from the normal being unit length
+		const __m128 one{ _mm_set1_ps(1.f) };
+		const __m128 two{ _mm_set1_ps(2.f) };
+		const __m128 normalX{ _mm_sub_ps(_mm_mul_ps(channels[4], two), one) };
+		const __m128 normalY{ _mm_sub_ps(_mm_mul_ps(channels[5], two), one) };
+		const __m128 normalZSquared{ _mm_sub_ps(_mm_sub_ps(one, _mm_mul_ps(normalX, normalX)), _mm_mul_ps(normalY, normalY)) };
+		const __m128 normalZ{ _mm_sqrt_ps(_mm_max_ps(normalZSquared, _mm_setzero_ps())) };
+
+		alignas(16) float lanes[8][4]{};
+		for (int channel{ 0 }; channel < 4; ++channel)
+			_mm_store_ps(lanes[channel], channels[channel]);
+		_mm_store_ps(lanes[4], normalX);
+		_mm_store_ps(lanes[5], normalY);
+		_mm_store_ps(lanes[6], normalZ);
+		_mm_store_ps(lanes[7], channels[6]);
+
+		for (int lane{ 0 }; lane < 4; ++lane)
+		{
+			MaterialSample& sample{ samples[lane] };
+			sample.diffuse = { lanes[0][lane], lanes[1][lane], lanes[2][lane] };
+			sample.specular = lanes[3][lane];
+			sample.normal = { lanes[4][lane], lanes[5][lane], lanes[6][lane] };
+			sample.gloss = lanes[7][lane];
+		}
+	}
+
+	void Material::SamplePointQuad(__m128 u, __m128 v, TextureAddressMode addressMode, QuadChannels& channels) const
+	{
+		const MipLevel& mip{ m_MipLevels[0] };
+		alignas(16) int x[4]{};
+		alignas(16) int y[4]{};
+		_mm_store_si128(reinterpret_cast<__m128i*>(x), _mm_cvttps_epi32(Sampling::AddressCoordinates(Sampling::Floor(_mm_mul_ps(u, _mm_set1_ps(float(mip.width)))), mip.width, addressMode)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(y), _mm_cvttps_epi32(Sampling::AddressCoordinates(Sampling::Floor(_mm_mul_ps(v, _mm_set1_ps(float(mip.height)))), mip.height, addressMode)));
+
+		BlockCache cache{};
+		Texel texels[4]{};
+		for (int lane{ 0 }; lane < 4; ++lane)
+			texels[lane] = FetchTexel(mip, x[lane], y[lane], cache);
+
+		UnpackQuad(texels, channels);
+	}
+
+	void Material::SampleBilinearQuad(__m128 u, __m128 v, int mipIdx, TextureAddressMode addressMode, QuadChannels& channels) const
+	{
+		const MipLevel& mip{ m_MipLevels[mipIdx] };
+		const Sampling::BilinearFootprint footprint{ Sampling::GetBilinearFootprint(u, v, mip.width, mip.height, addressMode) };
+
+		//one fetch per corner and lane brings in all 7 channels
+		BlockCache cache{};
+		Texel texels[4][4]{};
+		for (int lane{ 0 }; lane < 4; ++lane)
+		{
+			texels[0][lane] = FetchTexel(mip, footprint.x0[lane], footprint.y0[lane], cache);
+			texels[1][lane] = FetchTexel(mip, footprint.x1[lane], footprint.y0[lane], cache);
+			texels[2][lane] = FetchTexel(mip, footprint.x0[lane], footprint.y1[lane], cache);
+			texels[3][lane] = FetchTexel(mip, footprint.x1[lane], footprint.y1[lane], cache);
+		}
+
+		for (int channel{ 0 }; channel < m_ChannelCount; ++channel)
+			channels[channel] = _mm_setzero_ps();
+
+		for (int corner{ 0 }; corner < 4; ++corner)
+		{
+			QuadChannels cornerChannels{};
+			UnpackQuad(texels[corner], cornerChannels);
+			for (int channel{ 0 }; channel < m_ChannelCount; ++channel)
+				channels[channel] = _mm_add_ps(channels[channel], _mm_mul_ps(cornerChannels[channel], footprint.weights[corner]));
+		}
+	}
+}
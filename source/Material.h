@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "ColorRGB.h"
+#include "Sampler.h"
+#include "Vector3.h"
+
+namespace dae
+{
+	class Texture;
+
+	//everything the shading of one fragment reads from its material
+	struct MaterialSample
+	{
+		ColorRGB diffuse{};
+		Vector3 normal{}; //tangent space, z is rebuilt from x and y
+		float specular{};
+		float gloss{};
+	};
+
+	enum class MaterialFormat
+	{
+		packed,         //8 bytes per texel
+		blockCompressed //one 40 byte block per 4x4 texels: BC1 diffuse, BC4 specular and gloss, BC5 normal
+	};
+
+	//the diffuse, normal, specular and gloss maps interleaved into one texel, a fragment does a single addressed fetch
+	class Material final
+	{
+	public:
+		~Material() = default;
+
+		//every map is resampled to the resolution of the diffuse map (nearest texel)
+		//specular and gloss are greyscale, only their red channel is kept
+		static Material* Bake(const Texture& diffuse, const Texture& normal, const Texture& specular, const Texture& gloss,
+			MaterialFormat format = MaterialFormat::packed);
+
+		//the 4 pixels of a 2x2 quad share their derivatives and the mip level, like Texture::SampleQuad
+		void SampleQuad(const SamplerState& sampler, const Vector2 (&uvs)[4], const Vector2& uvDdx, const Vector2& uvDdy, MaterialSample (&samples)[4]) const;
+
+		int GetWidth() const { return m_Width; }
+		int GetHeight() const { return m_Height; }
+		int GetMipCount() const { return int(m_MipLevels.size()); }
+		MaterialFormat GetFormat() const { return m_Format; }
+		//all mip levels
+		size_t GetSizeInBytes() const { return m_Texels.size() * sizeof(Texel) + m_Blocks.size() * sizeof(Block); }
+
+	private:
+		Material(int width, int height);
+
+		//8 bytes, both words are read from the same cache line
+		struct Texel
+		{
+			uint32_t diffuseSpecular{}; //diffuse rgb, specular in the highest byte
+			uint32_t normalGloss{}; //normal x and y, gloss, highest byte unused
+		};
+
+		//the 4x4 texels of every map sit in the same block, so a fetch still touches one place in memory
+		struct Block
+		{
+			uint64_t diffuse{};
+			uint64_t specular{};
+			uint64_t normalX{};
+			uint64_t normalY{};
+			uint64_t gloss{};
+		};
+
+		struct MipLevel
+		{
+			int width{};
+			int height{};
+			size_t offset{}; //first texel of this level in m_Texels, first block in m_Blocks when compressed
+			int blocksPerRow{}; //compressed only
+		};
+
+		//diffuse rgb, specular, normal x, normal y and gloss of 4 lanes
+		static constexpr int m_ChannelCount{ 7 };
+		using QuadChannels = __m128[m_ChannelCount];
+
+		int m_Width{};
+		int m_Height{};
+		MaterialFormat m_Format{ MaterialFormat::packed };
+
+		//all mip levels back to back, level 0 first
+		std::vector<Texel> m_Texels{};
+		std::vector<MipLevel> m_MipLevels{};
+
+		//compressed only, m_Texels is empty then
+		std::vector<Block> m_Blocks{};
+
+		void BuildMipChain();
+		void Compress();
+
+		//the decoded palettes of a block, a texel is then 5 lookups
+		struct DecodedBlock
+		{
+			const Block* pBlock{};
+			uint32_t diffuse[4]{};
+			uint8_t specular[8]{};
+			uint8_t normalX[8]{};
+			uint8_t normalY[8]{};
+			uint8_t gloss[8]{};
+		};
+
+		//the neighbouring fetches of a quad mostly land in the same few blocks, each one is decoded once per quad
+		//2x2 slots picked by the block coordinates, so the 4 blocks around a block corner never evict each other
+		struct BlockCache
+		{
+			DecodedBlock slots[4]{};
+		};
+
+		Texel FetchTexel(const MipLevel& mip, int x, int y, BlockCache& cache) const
+		{
+			if (m_Format == MaterialFormat::packed)
+				return m_Texels[mip.offset + x + size_t(y) * mip.width];
+
+			const Block* pBlock{ &m_Blocks[mip.offset + size_t(y >> 2) * mip.blocksPerRow + (x >> 2)] };
+			DecodedBlock& decoded{ cache.slots[((x >> 2) & 1) | ((y >> 1) & 2)] };
+			if (decoded.pBlock != pBlock)
+				DecodeBlock(*pBlock, decoded);
+
+			const int texelIdx{ ((y & 3) << 2) + (x & 3) };
+			const int colorShift{ 32 + 2 * texelIdx };
+			const int valueShift{ 16 + 3 * texelIdx };
+			return {
+				(decoded.diffuse[(pBlock->diffuse >> colorShift) & 3] & 0xFFFFFF) | uint32_t(decoded.specular[(pBlock->specular >> valueShift) & 7]) << 24,
+				uint32_t(decoded.normalX[(pBlock->normalX >> valueShift) & 7]) | uint32_t(decoded.normalY[(pBlock->normalY >> valueShift) & 7]) << 8 |
+					uint32_t(decoded.gloss[(pBlock->gloss >> valueShift) & 7]) << 16 };
+		}
+
+		static void DecodeBlock(const Block& block, DecodedBlock& decoded);
+
+		void SamplePointQuad(__m128 u, __m128 v, TextureAddressMode addressMode, QuadChannels& channels) const;
+		void SampleBilinearQuad(__m128 u, __m128 v, int mipIdx, TextureAddressMode addressMode, QuadChannels& channels) const;
+	};
+}
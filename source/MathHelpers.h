@@ -1,5 +1,10 @@
 #pragma once
+#include <algorithm>
+#include <bit>
+#include <cfloat>
 #include <cmath>
+#include <cstdint>
+#include <emmintrin.h>
 
 namespace dae
 {
@@ -56,4 +61,81 @@ namespace dae
 		if (v > 1.f) return 1.f;
 		return v;
 	}
-}
\ No newline at end of file
+
+	//spreads the narrow band of depth values between min and max over the visible range
+	inline float Remap(float value, float min, float max)
+	{
+		return { min + value * max / (max - min) };
+	}
+
+	//log2 for x > 0, polynomial on the mantissa, the exponent is read from the bits
+	//absolute error below 9e-6, exact for powers of 2
+	inline float FastLog2(float x)
+	{
+		const uint32_t bits{ std::bit_cast<uint32_t>(x) };
+		const float exponent{ float(int(bits >> 23) - 127) };
+		const float m{ std::bit_cast<float>((bits & 0x007FFFFF) | 0x3F800000) - 1.f }; //[0, 1)
+
+		const float p{ 1.44268325f + m * (-0.720442293f + m * (0.469301204f + m * (-0.303388451f + m * (0.146432287f + m * -0.0345946877f)))) };
+		return exponent + m * p;
+	}
+
+	//2^x, the integer part goes straight into the exponent bits, polynomial on the fraction
+	//relative error below 8e-6, x is clamped to the normal float range
+	inline float FastExp2(float x)
+	{
+		x = std::min(std::max(x, -126.f), 127.f);
+		const int truncated{ int(x) };
+		const int whole{ truncated - int(x < float(truncated)) };
+		const float f{ x - float(whole) }; //[0, 1)
+
+		const float p{ 1.f + f * (0.693133593f + f * (0.240654318f + f * (0.0534215161f + f * 0.0127761769f))) };
+		return p * std::bit_cast<float>(uint32_t(whole + 127) << 23);
+	}
+
+	//x^y for x in [0, 1] and y >= 0, the range phong needs
+	//relative error below 8e-6 + 6e-6 * y, so under 1.6e-4 for the exponents up to 25 the gloss map gives
+	//x <= 0 is treated as the smallest normal float, so it returns 0 for any y that is not close to 0
+	inline float FastPow(float x, float y)
+	{
+		return FastExp2(y * FastLog2(std::max(x, FLT_MIN)));
+	}
+
+	//4 lanes of the functions above, same polynomials and so the same error bounds
+	inline __m128 FastLog2(__m128 x)
+	{
+		const __m128i bits{ _mm_castps_si128(x) };
+		const __m128 exponent{ _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127))) };
+		const __m128i mantissaBits{ _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)) };
+		const __m128 m{ _mm_sub_ps(_mm_castsi128_ps(mantissaBits), _mm_set1_ps(1.f)) };
+
+		__m128 p{ _mm_set1_ps(-0.0345946877f) };
+		p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(0.146432287f));
+		p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-0.303388451f));
+		p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(0.469301204f));
+		p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-0.720442293f));
+		p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(1.44268325f));
+		return _mm_add_ps(exponent, _mm_mul_ps(m, p));
+	}
+
+	inline __m128 FastExp2(__m128 x)
+	{
+		x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.f)), _mm_set1_ps(127.f));
+		const __m128i truncated{ _mm_cvttps_epi32(x) };
+		//the compare is all ones (-1) where truncating rounded up
+		const __m128i whole{ _mm_add_epi32(truncated, _mm_castps_si128(_mm_cmplt_ps(x, _mm_cvtepi32_ps(truncated)))) };
+		const __m128 f{ _mm_sub_ps(x, _mm_cvtepi32_ps(whole)) };
+
+		__m128 p{ _mm_set1_ps(0.0127761769f) };
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(0.0534215161f));
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(0.240654318f));
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(0.693133593f));
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.f));
+		return _mm_mul_ps(p, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, _mm_set1_epi32(127)), 23)));
+	}
+
+	inline __m128 FastPow(__m128 x, __m128 y)
+	{
+		return FastExp2(_mm_mul_ps(y, FastLog2(_mm_max_ps(x, _mm_set1_ps(FLT_MIN)))));
+	}
+}
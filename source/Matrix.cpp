@@ -176,6 +176,18 @@ namespace dae {
 		return out;
 	}
 
+	Matrix Matrix::CreateOrthographicLH(float width, float height, float zn, float zf)
+	{
+		//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixortholh
+		Matrix out{};
+		out.data[0] = { 2 / width, 0, 0, 0 };
+		out.data[1] = { 0, 2 / height, 0, 0 };
+		out.data[2] = { 0, 0, 1 / (zf - zn), 0 };
+		out.data[3] = { 0, 0, zn / (zn - zf), 1 };
+
+		return out;
+	}
+
 	Vector3 Matrix::GetAxisX() const
 	{
 		return data[0];
@@ -0,0 +1,389 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <array>
+#include <queue>
+#include <unordered_map>
+
+namespace dae
+{
+	namespace
+	{
+		//symmetric 4x4 matrix, only the upper triangle is stored
+		struct Quadric
+		{
+			double a2{}, ab{}, ac{}, ad{};
+			double b2{}, bc{}, bd{};
+			double c2{}, cd{};
+			double d2{};
+
+			static Quadric FromPlane(double a, double b, double c, double d, double weight)
+			{
+				return {
+					weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+					weight * b * b, weight * b * c, weight * b * d,
+					weight * c * c, weight * c * d,
+					weight * d * d };
+			}
+
+			double Evaluate(const Vector3& p) const
+			{
+				const double x{ p.x }, y{ p.y }, z{ p.z };
+				return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+					+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+					+ c2 * z * z + 2 * cd * z
+					+ d2;
+			}
+
+			Quadric& operator+=(const Quadric& q)
+			{
+				a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+				b2 += q.b2; bc += q.bc; bd += q.bd;
+				c2 += q.c2; cd += q.cd;
+				d2 += q.d2;
+				return *this;
+			}
+		};
+
+		struct Collapse
+		{
+			double cost{};
+			uint32_t keep{};
+			uint32_t remove{};
+			uint32_t keepVersion{};
+			uint32_t removeVersion{};
+			Vector3 target{};
+
+			bool operator>(const Collapse& other) const { return cost > other.cost; }
+		};
+
+		//boundary edges would otherwise be free to shrink, this keeps the outline in place
+		constexpr double g_BoundaryWeight{ 10.0 };
+
+		class Simplifier final
+		{
+		public:
+			Simplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) :
+				m_Vertices{ vertices }
+			{
+				WeldPositions(indices);
+				BuildQuadrics();
+			}
+
+			std::vector<MeshLOD> BuildChain(int maxLevels, size_t minTriangles)
+			{
+				std::vector<MeshLOD> lods{};
+				size_t previousCount{ m_TriangleCount };
+
+				while (int(lods.size()) < maxLevels)
+				{
+					const size_t targetCount{ previousCount / 2 };
+					if (targetCount < minTriangles)
+						break;
+
+					Simplify(targetCount);
+
+					//stuck (e.g. every remaining collapse would flip a triangle), no use in storing a near copy
+					if (m_TriangleCount > previousCount * 9 / 10)
+						break;
+
+					lods.push_back(Extract());
+					previousCount = m_TriangleCount;
+				}
+				return lods;
+			}
+
+		private:
+			const std::vector<Vertex>& m_Vertices;
+
+			//per welded position
+			std::vector<Vector3> m_Positions{};
+			std::vector<Quadric> m_Quadrics{};
+			std::vector<std::vector<uint32_t>> m_VertexTriangles{};
+			std::vector<uint32_t> m_Versions{};
+			std::vector<bool> m_IsAlive{};
+
+			//per triangle: welded ids and the original vertices that carry the attributes
+			std::vector<std::array<uint32_t, 3>> m_Triangles{};
+			std::vector<std::array<uint32_t, 3>> m_Corners{};
+			std::vector<bool> m_IsTriangleAlive{};
+			size_t m_TriangleCount{};
+
+			std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_Collapses{};
+			double m_MaxError{};
+
+			void WeldPositions(const std::vector<uint32_t>& indices)
+			{
+				struct PositionHash
+				{
+					size_t operator()(const Vector3& p) const
+					{
+						const std::hash<float> hasher{};
+						return hasher(p.x) ^ (hasher(p.y) * 73856093u) ^ (hasher(p.z) * 19349663u);
+					}
+				};
+				struct PositionEqual
+				{
+					bool operator()(const Vector3& a, const Vector3& b) const
+					{
+						return a.x == b.x && a.y == b.y && a.z == b.z;
+					}
+				};
+
+				//the OBJ parser writes one vertex per face corner, so positions are shared by value only
+				std::unordered_map<Vector3, uint32_t, PositionHash, PositionEqual> welded{};
+				std::vector<uint32_t> weldOf(m_Vertices.size());
+				for (size_t i{ 0 }; i < m_Vertices.size(); ++i)
+				{
+					const auto result{ welded.emplace(m_Vertices[i].position, uint32_t(m_Positions.size())) };
+					if (result.second)
+						m_Positions.push_back(m_Vertices[i].position);
+					weldOf[i] = result.first->second;
+				}
+
+				m_VertexTriangles.resize(m_Positions.size());
+				m_Versions.resize(m_Positions.size());
+				m_IsAlive.assign(m_Positions.size(), true);
+
+				for (size_t i{ 0 }; i + 2 < indices.size(); i += 3)
+				{
+					const std::array<uint32_t, 3> corners{ indices[i], indices[i + 1], indices[i + 2] };
+					const std::array<uint32_t, 3> triangle{ weldOf[corners[0]], weldOf[corners[1]], weldOf[corners[2]] };
+					if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0])
+						continue;
+
+					const uint32_t triangleIdx{ uint32_t(m_Triangles.size()) };
+					m_Triangles.push_back(triangle);
+					m_Corners.push_back(corners);
+					for (uint32_t v : triangle)
+						m_VertexTriangles[v].push_back(triangleIdx);
+				}
+				m_IsTriangleAlive.assign(m_Triangles.size(), true);
+				m_TriangleCount = m_Triangles.size();
+			}
+
+			void BuildQuadrics()
+			{
+				m_Quadrics.resize(m_Positions.size());
+
+				struct Edge
+				{
+					uint32_t a, b, triangle;
+					bool operator<(const Edge& other) const { return a != other.a ? a < other.a : b < other.b; }
+				};
+				std::vector<Edge> edges{};
+				edges.reserve(m_Triangles.size() * 3);
+
+				for (uint32_t t{ 0 }; t < uint32_t(m_Triangles.size()); ++t)
+				{
+					const auto& triangle{ m_Triangles[t] };
+					const Vector3 normal{ GetNormal(m_Positions[triangle[0]], m_Positions[triangle[1]], m_Positions[triangle[2]]) };
+					if (normal.SqrMagnitude() > 0.f)
+					{
+						const double d{ -Vector3::Dot(normal, m_Positions[triangle[0]]) };
+						const Quadric plane{ Quadric::FromPlane(normal.x, normal.y, normal.z, d, 1.0) };
+						for (uint32_t v : triangle)
+							m_Quadrics[v] += plane;
+					}
+
+					for (int i{ 0 }; i < 3; ++i)
+					{
+						const uint32_t a{ triangle[i] };
+						const uint32_t b{ triangle[(i + 1) % 3] };
+						edges.push_back({ std::min(a, b), std::max(a, b), t });
+					}
+				}
+
+				std::sort(edges.begin(), edges.end());
+				for (size_t i{ 0 }; i < edges.size();)
+				{
+					size_t end{ i + 1 };
+					while (end < edges.size() && edges[end].a == edges[i].a && edges[end].b == edges[i].b)
+						++end;
+
+					if (end - i == 1)
+						AddBoundaryQuadric(edges[i]);
+
+					i = end;
+				}
+
+				//quadrics are complete, now every unique edge can be priced
+				for (size_t i{ 0 }; i < edges.size(); ++i)
+				{
+					if (i > 0 && edges[i].a == edges[i - 1].a && edges[i].b == edges[i - 1].b)
+						continue;
+					PushCollapse(edges[i].a, edges[i].b);
+				}
+			}
+
+			template<typename EdgeType>
+			void AddBoundaryQuadric(const EdgeType& edge)
+			{
+				const auto& triangle{ m_Triangles[edge.triangle] };
+				const Vector3& a{ m_Positions[edge.a] };
+				const Vector3& b{ m_Positions[edge.b] };
+				const Vector3 normal{ GetNormal(m_Positions[triangle[0]], m_Positions[triangle[1]], m_Positions[triangle[2]]) };
+
+				Vector3 side{ Vector3::Cross(b - a, normal) };
+				if (side.SqrMagnitude() <= 0.f)
+					return;
+				side.Normalize();
+
+				const double d{ -Vector3::Dot(side, a) };
+				const Quadric plane{ Quadric::FromPlane(side.x, side.y, side.z, d, g_BoundaryWeight) };
+				m_Quadrics[edge.a] += plane;
+				m_Quadrics[edge.b] += plane;
+			}
+
+			static Vector3 GetNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+			{
+				const Vector3 normal{ Vector3::Cross(p1 - p0, p2 - p0) };
+				const float length{ normal.Magnitude() };
+				return length > 0.f ? normal / length : Vector3::Zero;
+			}
+
+			void PushCollapse(uint32_t a, uint32_t b)
+			{
+				Quadric quadric{ m_Quadrics[a] };
+				quadric += m_Quadrics[b];
+
+				//the endpoints and the midpoint are enough, solving for the optimum is often ill-conditioned on flat parts
+				const Vector3 options[3]{ m_Positions[a], m_Positions[b], (m_Positions[a] + m_Positions[b]) * 0.5f };
+				Collapse collapse{ quadric.Evaluate(options[0]), a, b, m_Versions[a], m_Versions[b], options[0] };
+				for (int i{ 1 }; i < 3; ++i)
+				{
+					const double cost{ quadric.Evaluate(options[i]) };
+					if (cost < collapse.cost)
+					{
+						collapse.cost = cost;
+						collapse.target = options[i];
+					}
+				}
+				collapse.cost = std::max(collapse.cost, 0.0);
+				m_Collapses.push(collapse);
+			}
+
+			bool FlipsTriangle(uint32_t v, uint32_t other, const Vector3& target) const
+			{
+				for (uint32_t t : m_VertexTriangles[v])
+				{
+					if (!m_IsTriangleAlive[t])
+						continue;
+
+					const auto& triangle{ m_Triangles[t] };
+					if (triangle[0] == other || triangle[1] == other || triangle[2] == other)
+						continue; //this one disappears
+
+					Vector3 moved[3]{ m_Positions[triangle[0]], m_Positions[triangle[1]], m_Positions[triangle[2]] };
+					const Vector3 before{ GetNormal(moved[0], moved[1], moved[2]) };
+					for (int i{ 0 }; i < 3; ++i)
+					{
+						if (triangle[i] == v)
+							moved[i] = target;
+					}
+					const Vector3 after{ GetNormal(moved[0], moved[1], moved[2]) };
+
+					if (Vector3::Dot(before, after) < 0.2f)
+						return true;
+				}
+				return false;
+			}
+
+			void Simplify(size_t targetCount)
+			{
+				while (m_TriangleCount > targetCount && !m_Collapses.empty())
+				{
+					const Collapse collapse{ m_Collapses.top() };
+					m_Collapses.pop();
+
+					const uint32_t keep{ collapse.keep };
+					const uint32_t remove{ collapse.remove };
+
+					//stale entry, one of the vertices changed since it was priced
+					if (!m_IsAlive[keep] || !m_IsAlive[remove] ||
+						m_Versions[keep] != collapse.keepVersion || m_Versions[remove] != collapse.removeVersion)
+						continue;
+
+					if (FlipsTriangle(keep, remove, collapse.target) || FlipsTriangle(remove, keep, collapse.target))
+						continue;
+
+					m_Positions[keep] = collapse.target;
+					m_Quadrics[keep] += m_Quadrics[remove];
+					m_IsAlive[remove] = false;
+					++m_Versions[keep];
+					m_MaxError = std::max(m_MaxError, collapse.cost);
+
+					for (uint32_t t : m_VertexTriangles[remove])
+					{
+						if (!m_IsTriangleAlive[t])
+							continue;
+
+						auto& triangle{ m_Triangles[t] };
+						if (triangle[0] == keep || triangle[1] == keep || triangle[2] == keep)
+						{
+							m_IsTriangleAlive[t] = false;
+							--m_TriangleCount;
+							continue;
+						}
+
+						for (uint32_t& v : triangle)
+						{
+							if (v == remove)
+								v = keep;
+						}
+						m_VertexTriangles[keep].push_back(t);
+					}
+					m_VertexTriangles[remove].clear();
+
+					//drop the dead triangles and reprice every edge around the survivor
+					auto& triangles{ m_VertexTriangles[keep] };
+					triangles.erase(std::remove_if(triangles.begin(), triangles.end(),
+						[this](uint32_t t) { return !m_IsTriangleAlive[t]; }), triangles.end());
+
+					for (uint32_t t : triangles)
+					{
+						for (uint32_t v : m_Triangles[t])
+						{
+							if (v != keep)
+								PushCollapse(keep, v);
+						}
+					}
+				}
+			}
+
+			MeshLOD Extract() const
+			{
+				MeshLOD lod{};
+				lod.error = float(std::sqrt(m_MaxError));
+
+				//every original vertex keeps its own attributes, only its position follows the collapses
+				std::vector<int> remap(m_Vertices.size(), -1);
+				for (size_t t{ 0 }; t < m_Triangles.size(); ++t)
+				{
+					if (!m_IsTriangleAlive[t])
+						continue;
+
+					for (int i{ 0 }; i < 3; ++i)
+					{
+						const uint32_t original{ m_Corners[t][i] };
+						if (remap[original] < 0)
+						{
+							remap[original] = int(lod.vertices.size());
+							Vertex vertex{ m_Vertices[original] };
+							vertex.position = m_Positions[m_Triangles[t][i]];
+							lod.vertices.push_back(vertex);
+						}
+						lod.indices.push_back(uint32_t(remap[original]));
+					}
+				}
+				return lod;
+			}
+		};
+	}
+
+	std::vector<MeshLOD> MeshSimplifier::BuildLODChain(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+		int maxLevels, size_t minTriangles)
+	{
+		Simplifier simplifier{ vertices, indices };
+		return simplifier.BuildChain(maxLevels, minTriangles);
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <vector>
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace MeshSimplifier
+	{
+		//Quadric error metric edge collapse (Garland & Heckbert 1997)
+		//every level has about half the triangles of the previous one, until minTriangles or maxLevels is reached
+		//the error of a level is the worst collapse it took, in object space units
+		std::vector<MeshLOD> BuildLODChain(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+			int maxLevels = 6, size_t minTriangles = 128);
+	}
+}
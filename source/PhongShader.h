@@ -0,0 +1,330 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+#include "LightGrid.h"
+#include "Material.h"
+#include "Math.h"
+#include "Matrix.h"
+#include "Sampler.h"
+#include "Shader.h"
+#include "ShadowMap.h"
+
+namespace dae
+{
+	enum class ShadingMode
+	{
+		observedArea, diffuse, specular, combined
+	};
+
+	//everything the shading reads that is the same for every pixel, filled once per frame
+	struct LightingConstants
+	{
+		Vector3 lightDirection{};
+		float diffuseScale{}; //light intensity / pi
+		float shininess{};
+		ColorRGB ambient{};
+		Vector3 cameraOrigin{};
+	};
+
+	//the tangent is only passed on when the normal map needs it, the world position for local lights and shadows
+	template<bool isUsingNormalMap, bool isUsingWorldPosition>
+	struct PhongVaryings;
+
+	template<>
+	struct PhongVaryings<false, false>
+	{
+		Vector2 uv{};
+		Vector3 normal{};
+		Vector3 viewDirection{};
+	};
+
+	template<>
+	struct PhongVaryings<true, false>
+	{
+		Vector2 uv{};
+		Vector3 normal{};
+		Vector3 viewDirection{};
+		Vector3 tangent{};
+	};
+
+	template<>
+	struct PhongVaryings<false, true>
+	{
+		Vector2 uv{};
+		Vector3 normal{};
+		Vector3 viewDirection{};
+		Vector3 worldPosition{};
+	};
+
+	template<>
+	struct PhongVaryings<true, true>
+	{
+		Vector2 uv{};
+		Vector3 normal{};
+		Vector3 viewDirection{};
+		Vector3 tangent{};
+		Vector3 worldPosition{};
+	};
+
+	template<bool isUsingNormalMap, bool isUsingWorldPosition>
+	struct PhongVertexShader
+	{
+		using Varyings = PhongVaryings<isUsingNormalMap, isUsingWorldPosition>;
+
+		Matrix worldMatrix{};
+		Matrix worldViewProjectionMatrix{};
+		Vector3 cameraOrigin{};
+
+		Vector4 Shade(const Vertex& vertex, Varyings& varyings) const
+		{
+			const Vector4 position{ worldViewProjectionMatrix.TransformPoint(vertex.position.ToPoint4()) };
+
+			//normals and tangents only use the world matrix
+			varyings.normal = worldMatrix.TransformVector(vertex.normal);
+			if constexpr (isUsingNormalMap)
+				varyings.tangent = worldMatrix.TransformVector(vertex.tangent);
+			if constexpr (isUsingWorldPosition)
+				varyings.worldPosition = worldMatrix.TransformPoint(vertex.position);
+
+			const Vector3 pos{ position.x / position.w, position.y / position.w, position.z / position.w };
+			varyings.viewDirection = (cameraOrigin - pos).Normalized();
+
+			varyings.uv = vertex.uv;
+			return position;
+		}
+	};
+
+	//4 shaded points, as the forward shaders interpolate them or the deferred pass reads them back from the g-buffer
+	struct PhongSurfaces
+	{
+		Vector3 positions[4]{}; //world space, local lights and shadows only
+		Vector3 normals[4]{};
+		Vector3 viewDirections[4]{}; //towards the eye, for the directional light
+		ColorRGB colors[4]{};
+		float speculars[4]{};
+		alignas(16) float exponents[4]{}; //gloss * shininess
+		bool isActive[4]{}; //lanes that are written, the others are skipped
+	};
+
+	//lambert diffuse and phong specular from one directional light, plus the point and spot lights of the tile with local lights
+	//with shadows the directional light is scaled by what the shadow map sees of every lane
+	//every variant only contains the work its mode needs
+	template<ShadingMode shadingMode, bool isUsingLocalLights, bool isUsingShadows>
+	struct PhongLighting
+	{
+		static constexpr bool isUsingColor{ shadingMode == ShadingMode::diffuse || shadingMode == ShadingMode::combined };
+		static constexpr bool isUsingPhong{ shadingMode == ShadingMode::specular || shadingMode == ShadingMode::combined };
+
+		LightingConstants constants{};
+		const LightGrid* pLightGrid{}; //local lights only, built for this frame
+		const ShadowMap* pShadowMap{}; //shadows only
+
+		//x and y pick the light list, all 4 lanes have to be in the same tile of the grid
+		void Shade(const PhongSurfaces& surfaces, int x, int y, ColorRGB (&colors)[4]) const
+		{
+			//the specular power of the 4 lanes is one evaluation
+			alignas(16) float phongs[4]{};
+			if constexpr (isUsingPhong)
+			{
+				alignas(16) float cosines[4]{};
+				for (int lane{ 0 }; lane < 4; ++lane)
+				{
+					if (!surfaces.isActive[lane])
+						continue;
+
+					const Vector3 reflect{ Vector3::Reflect(surfaces.normals[lane], -constants.lightDirection) };
+					cosines[lane] = std::max(0.f, Vector3::Dot(reflect, surfaces.viewDirections[lane]));
+				}
+				_mm_store_ps(phongs, FastPow(_mm_load_ps(cosines), _mm_load_ps(surfaces.exponents)));
+			}
+
+			ColorRGB localDiffuse[4]{};
+			ColorRGB localSpecular[4]{};
+			if constexpr (isUsingLocalLights && shadingMode != ShadingMode::observedArea)
+				ShadeLocalLights(surfaces, x, y, localDiffuse, localSpecular);
+
+			for (int lane{ 0 }; lane < 4; ++lane)
+			{
+				if (!surfaces.isActive[lane])
+					continue;
+
+				float visibility{ 1.f };
+				if constexpr (isUsingShadows)
+					visibility = pShadowMap->GetVisibility(surfaces.positions[lane], surfaces.normals[lane]);
+
+				colors[lane] = ShadePixel(surfaces.normals[lane], surfaces.colors[lane], surfaces.speculars[lane] * phongs[lane], visibility,
+					localDiffuse[lane], localSpecular[lane]);
+			}
+		}
+
+		//the lights of the tile one at a time, the 4 lanes at once
+		//local diffuse is the incoming light still to be multiplied by the albedo, local specular is final
+		void ShadeLocalLights(const PhongSurfaces& surfaces, int x, int y, ColorRGB (&localDiffuse)[4], ColorRGB (&localSpecular)[4]) const
+		{
+			const std::vector<Light>& lights{ pLightGrid->GetLights() };
+
+			Vector3 viewDirections[4]{};
+			if constexpr (isUsingPhong)
+			{
+				for (int lane{ 0 }; lane < 4; ++lane)
+					viewDirections[lane] = (constants.cameraOrigin - surfaces.positions[lane]).Normalized();
+			}
+
+			for (uint32_t lightIdx : pLightGrid->GetTileLights(x, y))
+			{
+				const Light& light{ lights[lightIdx] };
+				const float invSqrRange{ 1.f / (light.range * light.range) };
+
+				float irradiances[4]{};
+				alignas(16) float cosines[4]{};
+				for (int lane{ 0 }; lane < 4; ++lane)
+				{
+					if (!surfaces.isActive[lane])
+						continue;
+
+					Vector3 toLight{ light.position - surfaces.positions[lane] };
+					const float sqrDistance{ toLight.SqrMagnitude() };
+					if (sqrDistance >= light.range * light.range)
+						continue;
+					toLight /= sqrtf(sqrDistance);
+
+					const float lambertLaw{ Vector3::Dot(surfaces.normals[lane], toLight) };
+					if (lambertLaw <= 0.f)
+						continue;
+
+					//inverse square falloff, windowed so it reaches 0 at the range
+					const float window{ Square(Saturate(1.f - Square(sqrDistance * invSqrRange))) };
+					float attenuation{ window / std::max(sqrDistance, 0.01f) };
+					if (light.type == LightType::spot)
+					{
+						const float cosAngle{ Vector3::Dot(-toLight, light.direction) };
+						attenuation *= Square(Saturate((cosAngle - light.cosOuterAngle) / (light.cosInnerAngle - light.cosOuterAngle)));
+					}
+					irradiances[lane] = light.intensity * attenuation * lambertLaw;
+
+					if constexpr (isUsingPhong)
+					{
+						const Vector3 reflect{ Vector3::Reflect(-toLight, surfaces.normals[lane]) };
+						cosines[lane] = std::max(0.f, Vector3::Dot(reflect, viewDirections[lane]));
+					}
+				}
+
+				alignas(16) float phongs[4]{};
+				if constexpr (isUsingPhong)
+					_mm_store_ps(phongs, FastPow(_mm_load_ps(cosines), _mm_load_ps(surfaces.exponents)));
+
+				for (int lane{ 0 }; lane < 4; ++lane)
+				{
+					if constexpr (isUsingColor)
+						localDiffuse[lane] += light.color * irradiances[lane];
+					if constexpr (isUsingPhong)
+						localSpecular[lane] += light.color * (irradiances[lane] * surfaces.speculars[lane] * phongs[lane]);
+				}
+			}
+		}
+
+		//phong is specular * cosine^(gloss * shininess), evaluated for 4 lanes by Shade
+		//visibility is how much of the directional light reaches the pixel, the ambient is never shadowed
+		//the color is linear and unclamped, the resolve of the hdr buffer tonemaps it
+		ColorRGB ShadePixel(const Vector3& normal, const ColorRGB& color, float phong, float visibility,
+			const ColorRGB& localDiffuse, const ColorRGB& localSpecular) const
+		{
+			const float lambertLaw{ Saturate(Vector3::Dot(normal, -constants.lightDirection)) };
+
+			//observed area
+			const ColorRGB observedArea{ lambertLaw, lambertLaw, lambertLaw };
+
+			ColorRGB finalColor{};
+			if constexpr (shadingMode == ShadingMode::observedArea)
+				finalColor = observedArea * visibility;
+			else if constexpr (shadingMode == ShadingMode::specular)
+				finalColor = ColorRGB{ phong, phong, phong } * visibility;
+			else
+			{
+				//lambert
+				const ColorRGB lambert{ lambertLaw * color * constants.diffuseScale };
+
+				if constexpr (shadingMode == ShadingMode::diffuse)
+					finalColor = observedArea * lambert * visibility;
+				else
+					finalColor = { constants.ambient + (lambert * observedArea) * visibility + ColorRGB{ phong, phong, phong } * visibility };
+			}
+
+			if constexpr (isUsingLocalLights && isUsingColor)
+				finalColor += color * localDiffuse * (1.f / float(M_PI));
+			if constexpr (isUsingLocalLights && isUsingPhong)
+				finalColor += localSpecular;
+
+			return finalColor;
+		}
+	};
+
+	//samples the material and builds the normal of every lane, the lighting itself is PhongLighting
+	template<ShadingMode shadingMode, bool isUsingNormalMap, bool isShowingTexture, bool isUsingLocalLights, bool isUsingShadows>
+	struct PhongPixelShader
+	{
+		static constexpr bool isUsingWorldPosition{ isUsingLocalLights || isUsingShadows };
+
+		using Varyings = PhongVaryings<isUsingNormalMap, isUsingWorldPosition>;
+		using Lighting = PhongLighting<shadingMode, isUsingLocalLights, isUsingShadows>;
+
+		static constexpr bool isSamplingMaterial{ isUsingNormalMap || Lighting::isUsingPhong || (Lighting::isUsingColor && isShowingTexture) };
+
+		const Material* pMaterial{};
+		SamplerState sampler{};
+		Lighting lighting{};
+
+		void ShadeQuad(const PixelQuad<Varyings>& quad, ColorRGB (&colors)[4]) const
+		{
+			//one fetch per texel brings every map of the material in, for the 4 lanes at once
+			MaterialSample materialSamples[4]{};
+			if constexpr (isSamplingMaterial)
+			{
+				const Vector2 uvs[4]{ quad.varyings[0].uv, quad.varyings[1].uv, quad.varyings[2].uv, quad.varyings[3].uv };
+
+				//one derivative pair per quad, like the hardware does
+				const Vector2 uvDdx{ uvs[1] - uvs[0] };
+				const Vector2 uvDdy{ uvs[2] - uvs[0] };
+				pMaterial->SampleQuad(sampler, uvs, uvDdx, uvDdy, materialSamples);
+			}
+
+			PhongSurfaces surfaces{};
+			for (int lane{ 0 }; lane < 4; ++lane)
+			{
+				if (!quad.isVisible[lane])
+					continue;
+
+				const Varyings& pixel{ quad.varyings[lane] };
+				const MaterialSample& material{ materialSamples[lane] };
+
+				Vector3 normal{ pixel.normal };
+				if constexpr (isUsingNormalMap)
+				{
+					const Vector3 binormal{ Vector3::Cross(normal, pixel.tangent) };
+					const Matrix tangentSpaceAxis{ Matrix{pixel.tangent, binormal, normal, Vector3::Zero} };
+					normal = tangentSpaceAxis.TransformVector(material.normal);
+				}
+
+				if constexpr (Lighting::isUsingColor && isShowingTexture)
+					surfaces.colors[lane] = material.diffuse;
+				else if constexpr (Lighting::isUsingColor)
+				{
+					const float depth{ Remap(quad.depths[lane], 0.985f, 1.f) };
+					surfaces.colors[lane] = { depth, depth, depth };
+				}
+
+				if constexpr (isUsingWorldPosition)
+					surfaces.positions[lane] = pixel.worldPosition;
+				surfaces.normals[lane] = normal;
+				surfaces.viewDirections[lane] = pixel.viewDirection;
+				surfaces.speculars[lane] = material.specular;
+				surfaces.exponents[lane] = material.gloss * lighting.constants.shininess;
+				surfaces.isActive[lane] = true;
+			}
+
+			lighting.Shade(surfaces, quad.x, quad.y, colors);
+		}
+	};
+}
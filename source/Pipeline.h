@@ -0,0 +1,501 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "HDRBuffer.h"
+#include "JobSystem.h"
+#include "Math.h"
+#include "Shader.h"
+
+namespace dae
+{
+	//what a draw writes to, the depth buffer has the same width x height as the colors
+	struct RenderTarget
+	{
+		HDRBuffer* pColors{}; //linear, tonemapped into the back buffer at the end of the frame
+		float* pDepth{}; //one width x height plane per sample, sample 0 first
+		int width{};
+		int height{};
+		int sampleCount{ 1 }; //1, or HDRBuffer::multiSampleCount with colors that have as many
+	};
+
+	enum class DepthTest
+	{
+		less,     //nearer than what is there
+		lessEqual //also passes on the exact depth a depth prepass wrote, every pixel is then shaded once
+	};
+
+	//how many pixels share one run of the pixel shader, coverage and depth stay per pixel
+	//a coarse lane is shaded at the centre of its block and its color goes to every visible pixel of it
+	enum class ShadingRate
+	{
+		full = 1,
+		coarse2x2 = 2,
+		coarse4x4 = 4
+	};
+
+	//vertex stage, culling, rasterization in 2x2 quads and the depth test, with the shaders plugged in as template parameters
+	//the two stages run apart, the shaded vertices live in a buffer of the caller in between
+	//both stages are split into jobs: the vertices in batches, the target in bands of rows that each rasterize every triangle touching them
+	//one pipeline per vertex shader, it has no state of its own
+	template<VertexShader VertexShaderType>
+	class Pipeline final
+	{
+	public:
+		using Varyings = typename VertexShaderType::Varyings;
+
+		struct ShadedVertex
+		{
+			Vector4 position{}; //x and y in pixels, z the ndc depth, w the clip space w
+			Varyings varyings{}; //divided by w
+			bool isInside{}; //inside the view volume
+		};
+		using ShadedVertices = std::vector<ShadedVertex>;
+
+		//the vertex stage, straight through to the raster space of a width x height target
+		//touches nothing but vertices_out, draws into different buffers can be shaded on different threads
+		static void ShadeVertices(JobSystem& jobs, const VertexShaderType& vertexShader, const std::vector<Vertex>& vertices, int width, int height, ShadedVertices& vertices_out);
+
+		//the raster stage, for vertices shaded by ShadeVertices for a target of the same size
+		//std::nullptr_t as the pixel shader only runs the depth test, a surface pixel shader writes no pixels
+		//every pixel belongs to one band, the triangles still reach it in the order of the indices
+		//a coarse shading rate only applies to color pixel shaders, a surface shader writes its lanes to single pixels and always runs at the full rate
+		//a multisampled target tests coverage and depth per sample and still shades once per pixel, at the full rate and not for surface shaders
+		template<typename PixelShaderType>
+		static void RasterizeTriangles(JobSystem& jobs, const PixelShaderType* pPixelShader, const ShadedVertices& vertices, const std::vector<uint32_t>& indices,
+			const RenderTarget& target, DepthTest depthTest, ShadingRate shadingRate = ShadingRate::full);
+
+	private:
+		static constexpr int vertexBatchSize{ 2048 };
+		static constexpr int bandHeight{ 16 }; //a band holds whole rows of quads, also of the 8x8 ones at the coarsest shading rate
+
+		//a triangle that survived culling, with the rows its box covers
+		struct BandedTriangle
+		{
+			size_t firstIndex{};
+			int minY{};
+			int maxY{};
+		};
+
+		template<typename PixelShaderType, int shadingRate>
+		static void RasterizeBand(const PixelShaderType* pPixelShader, const ShadedVertices& vertices, const std::vector<uint32_t>& indices,
+			const std::vector<BandedTriangle>& triangles, const RenderTarget& target, DepthTest depthTest, int bandMinY, int bandMaxY);
+
+		//the rotated grid of 4x msaa, in pixels from the point a single sample target samples
+		static constexpr int sampleCount{ HDRBuffer::multiSampleCount };
+		static constexpr float sampleOffsets[sampleCount][2]{ { -2 / 16.f, -6 / 16.f }, { 6 / 16.f, -2 / 16.f }, { -6 / 16.f, 2 / 16.f }, { 2 / 16.f, 6 / 16.f } };
+		static constexpr float maxSampleOffset{ 6 / 16.f };
+
+		template<typename PixelShaderType>
+		static void RasterizeBandMultisampled(const PixelShaderType* pPixelShader, const ShadedVertices& vertices, const std::vector<uint32_t>& indices,
+			const std::vector<BandedTriangle>& triangles, const RenderTarget& target, DepthTest depthTest, int bandMinY, int bandMaxY);
+	};
+
+	template<VertexShader VertexShaderType>
+	void Pipeline<VertexShaderType>::ShadeVertices(JobSystem& jobs, const VertexShaderType& vertexShader, const std::vector<Vertex>& vertices, int width, int height, ShadedVertices& vertices_out)
+	{
+		//straight through to raster space
+		vertices_out.resize(vertices.size());
+		jobs.ParallelFor(int(vertices.size()), vertexBatchSize, [&](int begin, int end)
+			{
+				for (int i{ begin }; i < end; ++i)
+				{
+					Varyings varyings{};
+					Vector4 position{ vertexShader.Shade(vertices[i], varyings) };
+					position.x /= position.w;
+					position.y /= position.w;
+					position.z /= position.w;
+
+					ShadedVertex& vertex{ vertices_out[i] };
+					vertex.isInside = position.x >= -1 && position.x <= 1 && position.y >= -1 && position.y <= 1 && position.z >= 0 && position.z <= 1;
+					vertex.position = { ((position.x + 1) / 2) * width, ((1 - position.y) / 2) * height, position.z, position.w };
+					vertex.varyings = Varying::Divide(varyings, position.w);
+				}
+			});
+	}
+
+	template<VertexShader VertexShaderType>
+	template<typename PixelShaderType>
+	void Pipeline<VertexShaderType>::RasterizeTriangles(JobSystem& jobs, const PixelShaderType* pPixelShader, const ShadedVertices& vertices, const std::vector<uint32_t>& indices,
+		const RenderTarget& target, DepthTest depthTest, ShadingRate shadingRate)
+	{
+		//culled once, every band then only looks at the rows of what is left
+		std::vector<BandedTriangle> triangles{};
+		triangles.reserve(indices.size() / 3);
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			const ShadedVertex& vertex1{ vertices[indices[i]] };
+			const ShadedVertex& vertex2{ vertices[indices[i + 1]] };
+			const ShadedVertex& vertex3{ vertices[indices[i + 2]] };
+
+			//a triangle is dropped as soon as one of its vertices leaves the view volume
+			if (!vertex1.isInside || !vertex2.isInside || !vertex3.isInside)
+				continue;
+
+			//twice the signed area of the triangle, the inside test can only pass when it is positive
+			const Vector2 v1{ vertex1.position.x, vertex1.position.y };
+			const Vector2 v2{ vertex2.position.x, vertex2.position.y };
+			const Vector2 v3{ vertex3.position.x, vertex3.position.y };
+			if (Vector2::Cross(v2 - v1, v3 - v2) <= 0.f)
+				continue;
+
+			const int minY{ int(Clamp(std::min(v3.y, std::min(v1.y, v2.y)), 1.f, target.height - 1.f)) };
+			const int maxY{ int(Clamp(ceilf(std::max(v3.y, std::max(v1.y, v2.y))), 1.f, target.height - 1.f)) };
+			triangles.push_back({ i, minY & ~1, maxY });
+		}
+
+		//the rate is a template parameter of the band, the loops over the pixels of a lane unroll
+		using RasterizeBandFunction = void (*)(const PixelShaderType*, const ShadedVertices&, const std::vector<uint32_t>&,
+			const std::vector<BandedTriangle>&, const RenderTarget&, DepthTest, int, int);
+		RasterizeBandFunction rasterizeBand{ &RasterizeBand<PixelShaderType, 1> };
+		if constexpr (!SurfacePixelShader<PixelShaderType, Varyings>)
+		{
+			if (target.sampleCount > 1)
+				rasterizeBand = &RasterizeBandMultisampled<PixelShaderType>;
+		}
+		if constexpr (ColorPixelShader<PixelShaderType, Varyings>)
+		{
+			if (target.sampleCount == 1 && shadingRate == ShadingRate::coarse2x2)
+				rasterizeBand = &RasterizeBand<PixelShaderType, 2>;
+			else if (target.sampleCount == 1 && shadingRate == ShadingRate::coarse4x4)
+				rasterizeBand = &RasterizeBand<PixelShaderType, 4>;
+		}
+
+		const int bandCount{ (target.height + bandHeight - 1) / bandHeight };
+		jobs.ParallelFor(bandCount, 1, [&](int firstBand, int lastBand)
+			{
+				for (int band{ firstBand }; band < lastBand; ++band)
+					rasterizeBand(pPixelShader, vertices, indices, triangles, target, depthTest, band * bandHeight, (band + 1) * bandHeight - 1);
+			});
+	}
+
+	template<VertexShader VertexShaderType>
+	template<typename PixelShaderType, int shadingRate>
+	void Pipeline<VertexShaderType>::RasterizeBand(const PixelShaderType* pPixelShader, const ShadedVertices& vertices, const std::vector<uint32_t>& indices,
+		const std::vector<BandedTriangle>& triangles, const RenderTarget& target, DepthTest depthTest, int bandMinY, int bandMaxY)
+	{
+		constexpr bool isDepthOnly{ std::is_same_v<PixelShaderType, std::nullptr_t> };
+
+		//a quad is 2x2 lanes of shadingRate x shadingRate pixels, at the full rate every lane is one pixel
+		constexpr int quadSize{ 2 * shadingRate };
+		constexpr int quadPixelCount{ quadSize * quadSize };
+		static_assert(bandHeight % quadSize == 0);
+
+		for (const BandedTriangle& triangle : triangles)
+		{
+			if (triangle.maxY < bandMinY || triangle.minY > bandMaxY)
+				continue;
+
+			const size_t i{ triangle.firstIndex };
+			const ShadedVertex& vertex1{ vertices[indices[i]] };
+			const ShadedVertex& vertex2{ vertices[indices[i + 1]] };
+			const ShadedVertex& vertex3{ vertices[indices[i + 2]] };
+
+			//edges
+			const Vector2 v1{ vertex1.position.x, vertex1.position.y };
+			const Vector2 v2{ vertex2.position.x, vertex2.position.y };
+			const Vector2 v3{ vertex3.position.x, vertex3.position.y };
+			const Vector2 v1v2{ v2 - v1 };
+			const Vector2 v2v3{ v3 - v2 };
+			const Vector2 v3v1{ v1 - v3 };
+
+			const float area{ Vector2::Cross(v1v2, v2v3) };
+
+			const int minX{ int(Clamp(std::min(v3.x, std::min(v1.x, v2.x)), 1.f, target.width - 1.f)) };
+			const int minY{ int(Clamp(std::min(v3.y, std::min(v1.y, v2.y)), 1.f, target.height - 1.f)) };
+			const int maxX{ int(Clamp(ceilf(std::max(v3.x, std::max(v1.x, v2.x))), 1.f, target.width - 1.f)) };
+			const int maxY{ int(Clamp(ceilf(std::max(v3.y, std::max(v1.y, v2.y))), 1.f, target.height - 1.f)) };
+
+			//walk the part of the box inside the band in quads, every lane then has neighbours to take derivatives from
+			for (int quadY{ std::max(minY & ~(quadSize - 1), bandMinY) }; quadY <= std::min(maxY, bandMaxY); quadY += quadSize)
+			{
+				for (int quadX{ minX & ~(quadSize - 1) }; quadX <= maxX; quadX += quadSize)
+				{
+					//pixel x + quadSize * y of the quad, with the lane it belongs to
+					float weights[quadPixelCount][3]{};
+					bool isCovered[quadPixelCount]{};
+					bool isQuadCovered{ false };
+
+					for (int pixel{ 0 }; pixel < quadPixelCount; ++pixel)
+					{
+						const int px{ quadX + pixel % quadSize };
+						const int py{ quadY + pixel / quadSize };
+
+						//a full rate lane outside the box is still interpolated for the derivatives, a coarse one is shaded at the centre of its block
+						if constexpr (shadingRate > 1)
+						{
+							if (px < minX || px > maxX || py < minY || py > maxY)
+								continue;
+						}
+
+						const Vector2 position{ float(px), float(py) };
+
+						const float signedArea1{ Vector2::Cross(v1v2, position - v1) };
+						const float signedArea2{ Vector2::Cross(v2v3, position - v2) };
+						const float signedArea3{ Vector2::Cross(v3v1, position - v3) };
+
+						//weights, left signed so they extrapolate for the pixels of the quad outside the triangle
+						weights[pixel][0] = signedArea2 / area;
+						weights[pixel][1] = signedArea3 / area;
+						weights[pixel][2] = signedArea1 / area;
+
+						isCovered[pixel] = signedArea1 >= 0 && signedArea2 >= 0 && signedArea3 >= 0 &&
+							px >= minX && px <= maxX && py >= minY && py <= maxY;
+						isQuadCovered = isQuadCovered || isCovered[pixel];
+					}
+
+					if (!isQuadCovered)
+						continue;
+
+					//depth test first, the quad is only shaded when at least one of its pixels survives
+					PixelQuad<Varyings> quad{};
+					bool isVisible[quadPixelCount]{};
+					bool isQuadVisible{ false };
+					for (int pixel{ 0 }; pixel < quadPixelCount; ++pixel)
+					{
+						if (!isCovered[pixel])
+							continue;
+
+						const float w1{ weights[pixel][0] };
+						const float w2{ weights[pixel][1] };
+						const float w3{ weights[pixel][2] };
+						const float depth{ 1 / ((w1 / vertex1.position.z) + (w2 / vertex2.position.z) + (w3 / vertex3.position.z)) };
+
+						//frustum clipping
+						if (depth <= 0 || depth >= 1)
+							continue;
+
+						const int currentPixel{ quadX + pixel % quadSize + (quadY + pixel / quadSize) * target.width };
+						const float bufferDepth{ target.pDepth[currentPixel] };
+						if (depthTest == DepthTest::less ? depth >= bufferDepth : depth > bufferDepth)
+							continue;
+
+						target.pDepth[currentPixel] = depth;
+
+						//a coarse lane is visible as soon as one of its pixels is, it takes the depth of the last one
+						const int lane{ (pixel % quadSize) / shadingRate + 2 * ((pixel / quadSize) / shadingRate) };
+						quad.depths[lane] = depth;
+						quad.isVisible[lane] = true;
+						isVisible[pixel] = true;
+						isQuadVisible = true;
+					}
+
+					if (isDepthOnly || !isQuadVisible)
+						continue;
+
+					//every lane is interpolated, the pixel shader takes its derivatives across the quad
+					for (int lane{ 0 }; lane < 4; ++lane)
+					{
+						float w1{}, w2{}, w3{};
+						if constexpr (shadingRate == 1)
+						{
+							w1 = weights[lane][0];
+							w2 = weights[lane][1];
+							w3 = weights[lane][2];
+						}
+						else
+						{
+							//the centre of the block, the derivatives then span shadingRate pixels and the sampler picks a coarser mip
+							constexpr float centreOffset{ (shadingRate - 1) * 0.5f };
+							const Vector2 position{ float(quadX + (lane & 1) * shadingRate) + centreOffset, float(quadY + (lane >> 1) * shadingRate) + centreOffset };
+							w1 = Vector2::Cross(v2v3, position - v2) / area;
+							w2 = Vector2::Cross(v3v1, position - v3) / area;
+							w3 = Vector2::Cross(v1v2, position - v1) / area;
+						}
+						const float w{ 1 / ((w1 / vertex1.position.w) + (w2 / vertex2.position.w) + (w3 / vertex3.position.w)) };
+						quad.varyings[lane] = Varying::Interpolate(vertex1.varyings, vertex2.varyings, vertex3.varyings, w1, w2, w3, w);
+					}
+
+					quad.x = quadX;
+					quad.y = quadY;
+
+					if constexpr (SurfacePixelShader<PixelShaderType, Varyings>)
+						pPixelShader->ShadeQuad(quad); //writes its own targets
+					else if constexpr (ColorPixelShader<PixelShaderType, Varyings>)
+					{
+						ColorRGB colors[4]{};
+						pPixelShader->ShadeQuad(quad, colors);
+
+						//overdrawn pixels only cost the store, the conversion to 8 bits happens once per pixel in the resolve
+						for (int pixel{ 0 }; pixel < quadPixelCount; ++pixel)
+						{
+							if (!isVisible[pixel])
+								continue;
+
+							const int lane{ (pixel % quadSize) / shadingRate + 2 * ((pixel / quadSize) / shadingRate) };
+							const int currentPixel{ quadX + pixel % quadSize + (quadY + pixel / quadSize) * target.width };
+							target.pColors->Write(currentPixel, colors[lane]);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	template<VertexShader VertexShaderType>
+	template<typename PixelShaderType>
+	void Pipeline<VertexShaderType>::RasterizeBandMultisampled(const PixelShaderType* pPixelShader, const ShadedVertices& vertices, const std::vector<uint32_t>& indices,
+		const std::vector<BandedTriangle>& triangles, const RenderTarget& target, DepthTest depthTest, int bandMinY, int bandMaxY)
+	{
+		constexpr uint32_t allSamples{ (1u << sampleCount) - 1 };
+		const int planeSize{ target.width * target.height };
+
+		for (const BandedTriangle& triangle : triangles)
+		{
+			if (triangle.maxY < bandMinY || triangle.minY > bandMaxY)
+				continue;
+
+			const size_t i{ triangle.firstIndex };
+			const ShadedVertex& vertex1{ vertices[indices[i]] };
+			const ShadedVertex& vertex2{ vertices[indices[i + 1]] };
+			const ShadedVertex& vertex3{ vertices[indices[i + 2]] };
+
+			//edges
+			const Vector2 v1{ vertex1.position.x, vertex1.position.y };
+			const Vector2 v2{ vertex2.position.x, vertex2.position.y };
+			const Vector2 v3{ vertex3.position.x, vertex3.position.y };
+			const Vector2 v1v2{ v2 - v1 };
+			const Vector2 v2v3{ v3 - v2 };
+			const Vector2 v3v1{ v1 - v3 };
+
+			const float area{ Vector2::Cross(v1v2, v2v3) };
+
+			const int minX{ int(Clamp(std::min(v3.x, std::min(v1.x, v2.x)), 1.f, target.width - 1.f)) };
+			const int minY{ int(Clamp(std::min(v3.y, std::min(v1.y, v2.y)), 1.f, target.height - 1.f)) };
+			const int maxX{ int(Clamp(ceilf(std::max(v3.x, std::max(v1.x, v2.x))), 1.f, target.width - 1.f)) };
+			const int maxY{ int(Clamp(ceilf(std::max(v3.y, std::max(v1.y, v2.y))), 1.f, target.height - 1.f)) };
+
+			//1 / depth is linear in screen space, a sample takes the value of its pixel plus its offset along these
+			const float inverseDepthDx{ -(v2v3.y / vertex1.position.z + v3v1.y / vertex2.position.z + v1v2.y / vertex3.position.z) / area };
+			const float inverseDepthDy{ (v2v3.x / vertex1.position.z + v3v1.x / vertex2.position.z + v1v2.x / vertex3.position.z) / area };
+
+			//a pixel at least this far inside every edge has all of its samples inside, the interior skips the test per sample
+			const float interiorMargin1{ maxSampleOffset * (fabsf(v1v2.x) + fabsf(v1v2.y)) };
+			const float interiorMargin2{ maxSampleOffset * (fabsf(v2v3.x) + fabsf(v2v3.y)) };
+			const float interiorMargin3{ maxSampleOffset * (fabsf(v3v1.x) + fabsf(v3v1.y)) };
+
+			for (int quadY{ std::max(minY & ~1, bandMinY) }; quadY <= std::min(maxY, bandMaxY); quadY += 2)
+			{
+				for (int quadX{ minX & ~1 }; quadX <= maxX; quadX += 2)
+				{
+					float weights[4][3]{};
+					uint32_t coveredSamples[4]{}; //bit i is sample i
+					bool isQuadCovered{ false };
+
+					for (int lane{ 0 }; lane < 4; ++lane)
+					{
+						const int px{ quadX + (lane & 1) };
+						const int py{ quadY + (lane >> 1) };
+						const Vector2 position{ float(px), float(py) };
+
+						const float signedArea1{ Vector2::Cross(v1v2, position - v1) };
+						const float signedArea2{ Vector2::Cross(v2v3, position - v2) };
+						const float signedArea3{ Vector2::Cross(v3v1, position - v3) };
+
+						//weights at the pixel, it is shaded there whichever of its samples are covered
+						weights[lane][0] = signedArea2 / area;
+						weights[lane][1] = signedArea3 / area;
+						weights[lane][2] = signedArea1 / area;
+
+						if (px < minX || px > maxX || py < minY || py > maxY)
+							continue;
+
+						if (signedArea1 >= interiorMargin1 && signedArea2 >= interiorMargin2 && signedArea3 >= interiorMargin3)
+							coveredSamples[lane] = allSamples;
+						else
+						{
+							for (int sample{ 0 }; sample < sampleCount; ++sample)
+							{
+								const float dx{ sampleOffsets[sample][0] };
+								const float dy{ sampleOffsets[sample][1] };
+								if (signedArea1 + v1v2.x * dy - v1v2.y * dx >= 0 && signedArea2 + v2v3.x * dy - v2v3.y * dx >= 0 &&
+									signedArea3 + v3v1.x * dy - v3v1.y * dx >= 0)
+									coveredSamples[lane] |= 1u << sample;
+							}
+						}
+						isQuadCovered = isQuadCovered || coveredSamples[lane] != 0;
+					}
+
+					if (!isQuadCovered)
+						continue;
+
+					//depth test per sample, a pixel is shaded when at least one of its samples survives
+					PixelQuad<Varyings> quad{};
+					uint32_t visibleSamples[4]{};
+					bool isQuadVisible{ false };
+					for (int lane{ 0 }; lane < 4; ++lane)
+					{
+						if (!coveredSamples[lane])
+							continue;
+
+						const float inverseDepth{ weights[lane][0] / vertex1.position.z + weights[lane][1] / vertex2.position.z + weights[lane][2] / vertex3.position.z };
+						const int currentPixel{ quadX + (lane & 1) + (quadY + (lane >> 1)) * target.width };
+						for (int sample{ 0 }; sample < sampleCount; ++sample)
+						{
+							if (!(coveredSamples[lane] & (1u << sample)))
+								continue;
+
+							const float depth{ 1 / (inverseDepth + inverseDepthDx * sampleOffsets[sample][0] + inverseDepthDy * sampleOffsets[sample][1]) };
+
+							//frustum clipping
+							if (depth <= 0 || depth >= 1)
+								continue;
+
+							float& bufferDepth{ target.pDepth[sample * planeSize + currentPixel] };
+							if (depthTest == DepthTest::less ? depth >= bufferDepth : depth > bufferDepth)
+								continue;
+
+							bufferDepth = depth;
+							visibleSamples[lane] |= 1u << sample;
+						}
+
+						if (!visibleSamples[lane])
+							continue;
+
+						quad.depths[lane] = 1 / inverseDepth;
+						quad.isVisible[lane] = true;
+						isQuadVisible = true;
+					}
+
+					if constexpr (ColorPixelShader<PixelShaderType, Varyings>)
+					{
+						if (!isQuadVisible)
+							continue;
+
+						for (int lane{ 0 }; lane < 4; ++lane)
+						{
+							const float w1{ weights[lane][0] };
+							const float w2{ weights[lane][1] };
+							const float w3{ weights[lane][2] };
+							const float w{ 1 / ((w1 / vertex1.position.w) + (w2 / vertex2.position.w) + (w3 / vertex3.position.w)) };
+							quad.varyings[lane] = Varying::Interpolate(vertex1.varyings, vertex2.varyings, vertex3.varyings, w1, w2, w3, w);
+						}
+
+						quad.x = quadX;
+						quad.y = quadY;
+
+						ColorRGB colors[4]{};
+						pPixelShader->ShadeQuad(quad, colors);
+
+						//a pixel with every sample visible stays one color, only the edges store their samples apart
+						for (int lane{ 0 }; lane < 4; ++lane)
+						{
+							if (!visibleSamples[lane])
+								continue;
+
+							const int currentPixel{ quadX + (lane & 1) + (quadY + (lane >> 1)) * target.width };
+							if (visibleSamples[lane] == allSamples)
+								target.pColors->WriteCovered(currentPixel, colors[lane]);
+							else
+								target.pColors->WriteSamples(currentPixel, visibleSamples[lane], colors[lane]);
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,10 @@
+#include "PixelFormat.h"
+#include "SDL_pixels.h"
+
+namespace dae
+{
+	PixelFormat PixelFormat::FromSDL(const SDL_PixelFormat* pFormat)
+	{
+		return { pFormat->Rshift, pFormat->Gshift, pFormat->Bshift, pFormat->Amask };
+	}
+}
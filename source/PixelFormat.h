@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <emmintrin.h>
+
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	//where the channels of a 32 bit pixel go, resolved once from the surface instead of per pixel by SDL_MapRGB
+	//only formats with 8 bits per channel, like the back buffer the renderer creates
+	struct PixelFormat
+	{
+		uint32_t redShift{ 16 };
+		uint32_t greenShift{ 8 };
+		uint32_t blueShift{ 0 };
+		uint32_t alphaMask{}; //set in full, like SDL_MapRGB does
+
+		static PixelFormat FromSDL(const SDL_PixelFormat* pFormat);
+
+		//4 pixels at once, the channels as one register each, truncated to 8 bits like static_cast<uint8_t>(channel * 255)
+		__m128i Pack(__m128 red, __m128 green, __m128 blue) const
+		{
+			const __m128 scale{ _mm_set1_ps(255.f) };
+			const __m128i max{ _mm_set1_epi32(255) };
+			const auto toByte{ [&](__m128 channel)
+				{
+					//truncates like the cast, the clamp keeps an out of range channel from spilling into its neighbours
+					const __m128i value{ _mm_cvttps_epi32(_mm_mul_ps(channel, scale)) };
+					const __m128i clamped{ _mm_and_si128(value, _mm_cmpgt_epi32(value, _mm_setzero_si128())) };
+					const __m128i isAboveMax{ _mm_cmpgt_epi32(clamped, max) };
+					return _mm_or_si128(_mm_andnot_si128(isAboveMax, clamped), _mm_and_si128(isAboveMax, max));
+				} };
+
+			__m128i packed{ _mm_sll_epi32(toByte(red), _mm_cvtsi32_si128(int(redShift))) };
+			packed = _mm_or_si128(packed, _mm_sll_epi32(toByte(green), _mm_cvtsi32_si128(int(greenShift))));
+			packed = _mm_or_si128(packed, _mm_sll_epi32(toByte(blue), _mm_cvtsi32_si128(int(blueShift))));
+			return _mm_or_si128(packed, _mm_set1_epi32(int(alphaMask)));
+		}
+	};
+}
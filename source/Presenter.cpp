@@ -0,0 +1,88 @@
+#include "Presenter.h"
+#include "SDL.h"
+#include "SDL_surface.h"
+
+namespace dae
+{
+	Presenter::Presenter(SDL_Window* pWindow, int width, int height) :
+		m_pWindow{ pWindow },
+		m_pFrontBuffer{ SDL_GetWindowSurface(pWindow) }
+	{
+		for (SDL_Surface*& pBackBuffer : m_BackBuffers)
+			pBackBuffer = SDL_CreateRGBSurface(0, width, height, 32, 0, 0, 0, 0);
+
+		m_Thread = std::thread{ &Presenter::Run, this };
+	}
+
+	Presenter::~Presenter()
+	{
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_Condition.notify_all();
+		m_Thread.join();
+
+		for (SDL_Surface*& pBackBuffer : m_BackBuffers)
+		{
+			SDL_FreeSurface(pBackBuffer);
+			pBackBuffer = nullptr;
+		}
+	}
+
+	SDL_Surface* Presenter::AcquireBackBuffer()
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_Condition.wait(lock, [this]() { return m_PresentedFrames + 1 >= m_SubmittedFrames; });
+		return m_BackBuffers[m_SubmittedFrames % 2];
+	}
+
+	void Presenter::Present(int width, int height)
+	{
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_ImageSizes[m_SubmittedFrames % 2] = { width, height };
+			++m_SubmittedFrames;
+		}
+		m_Condition.notify_all();
+	}
+
+	void Presenter::Flush()
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_Condition.wait(lock, [this]() { return m_PresentedFrames == m_SubmittedFrames; });
+	}
+
+	void Presenter::Run()
+	{
+		std::unique_lock lock{ m_Mutex };
+		while (true)
+		{
+			//a stop request still lets the frames that were handed over through
+			m_Condition.wait(lock, [this]() { return m_PresentedFrames < m_SubmittedFrames || m_IsStopping; });
+			if (m_PresentedFrames == m_SubmittedFrames)
+				return;
+
+			SDL_Surface* pBackBuffer{ m_BackBuffers[m_PresentedFrames % 2] };
+			const auto [width, height] { m_ImageSizes[m_PresentedFrames % 2] };
+			lock.unlock();
+
+			if (width == pBackBuffer->w && height == pBackBuffer->h)
+				SDL_BlitSurface(pBackBuffer, 0, m_pFrontBuffer, 0);
+			else
+			{
+				//a surface over just the packed image, nearest neighbour stretched to the window
+				const SDL_PixelFormat* pFormat{ pBackBuffer->format };
+				SDL_Surface* pImage{ SDL_CreateRGBSurfaceFrom(pBackBuffer->pixels, width, height, 32, width * 4,
+					pFormat->Rmask, pFormat->Gmask, pFormat->Bmask, pFormat->Amask) };
+				SDL_BlitScaled(pImage, 0, m_pFrontBuffer, 0);
+				SDL_FreeSurface(pImage);
+			}
+			SDL_UpdateWindowSurface(m_pWindow);
+
+			lock.lock();
+			++m_PresentedFrames;
+			m_Condition.notify_all();
+		}
+	}
+}
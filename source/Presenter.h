@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct SDL_Window;
+struct SDL_Surface;
+
+namespace dae
+{
+	//shows finished frames on a thread of its own, the blit and window update of frame n overlap with rendering frame n + 1
+	//frames rendered below the window resolution are upscaled here, off the render thread
+	//two back buffers take turns, the render thread only waits when the one it wants is still on its way to the window
+	class Presenter final
+	{
+	public:
+		Presenter(SDL_Window* pWindow, int width, int height);
+		~Presenter(); //shows what was handed over, then stops the thread
+
+		Presenter(const Presenter&) = delete;
+		Presenter(Presenter&&) noexcept = delete;
+		Presenter& operator=(const Presenter&) = delete;
+		Presenter& operator=(Presenter&&) noexcept = delete;
+
+		//the buffer to render the next frame into, blocks until the frame that used it last is presented (the fence)
+		SDL_Surface* AcquireBackBuffer();
+
+		//hands the acquired buffer to the present thread and returns right away
+		//the image is width x height pixels packed at the start of the buffer, a smaller one is stretched to the window
+		void Present(int width, int height);
+
+		//blocks until every frame handed over is on the window
+		void Flush();
+
+	private:
+		SDL_Window* m_pWindow{};
+		SDL_Surface* m_pFrontBuffer{};
+		std::array<SDL_Surface*, 2> m_BackBuffers{};
+		std::array<std::array<int, 2>, 2> m_ImageSizes{}; //width and height of what each back buffer holds
+
+		//frame n is rendered into buffer n % 2, it can start once frame n - 2 is presented
+		uint64_t m_SubmittedFrames{};
+		uint64_t m_PresentedFrames{};
+		bool m_IsStopping{ false };
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Condition{};
+		std::thread m_Thread{};
+
+		void Run();
+	};
+}
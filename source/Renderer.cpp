@@ -4,11 +4,18 @@
 
 //Project includes
 #include "Renderer.h"
+#include "AssetCache.h"
 #include "Math.h"
 #include "Matrix.h"
+#include "Presenter.h"
+#include "Material.h"
+#include "Scene.h"
 #include "Texture.h"
-#include "Utils.h"
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
 
 using namespace dae;
 
@@ -17,92 +24,173 @@ Renderer::Renderer(SDL_Window* pWindow) :
 {
 	//Initialize
 	SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
+	m_pJobs = new JobSystem();
 
 	//Create Buffers
-	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
-	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
+	m_pPresenter = new Presenter(pWindow, m_Width, m_Height);
+	m_pBackBuffer = m_pPresenter->AcquireBackBuffer();
 	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
-	m_pDepthBufferPixels = new float[m_Width * m_Height];
-
-	m_pTexture = Texture::LoadFromFile("./Resources/tuktuk.png");
-	m_pNormal = Texture::LoadFromFile("./Resources/vehicle_normal.png");
-	m_pDiffuse = Texture::LoadFromFile("./Resources/vehicle_diffuse.png"); 
-	m_pGloss = Texture::LoadFromFile("./Resources/vehicle_gloss.png");
-	m_pSpecular = Texture::LoadFromFile("./Resources/vehicle_specular.png");
+	m_PixelFormat = PixelFormat::FromSDL(m_pBackBuffer->format);
+	m_pDepthBufferPixels = new float[m_Width * m_Height * HDRBuffer::multiSampleCount];
+	m_pHDRBuffer = new HDRBuffer(m_Width, m_Height);
+	m_pGBuffer = new GBuffer(m_Width, m_Height);
+	m_pShadowMap = new ShadowMap(1024);
+
+	m_pAssets = new AssetCache(*m_pJobs);
+
+	//every asset starts loading at once, the constructor waits for them together further down
+	std::shared_future<TextureHandle> tuktukTexture{ m_pAssets->RequestTexture("./Resources/tuktuk.png") };
+	std::shared_future<TextureHandle> normalMap{ m_pAssets->RequestTexture("./Resources/vehicle_normal.png") };
+	std::shared_future<TextureHandle> diffuseMap{ m_pAssets->RequestTexture("./Resources/vehicle_diffuse.png") };
+	std::shared_future<TextureHandle> glossMap{ m_pAssets->RequestTexture("./Resources/vehicle_gloss.png") };
+	std::shared_future<TextureHandle> specularMap{ m_pAssets->RequestTexture("./Resources/vehicle_specular.png") };
+	std::shared_future<GeometryHandle> vehicleMesh{ m_pAssets->RequestMesh("Resources/vehicle.obj") };
+	std::shared_future<GeometryHandle> tuktukMesh{ m_pAssets->RequestMesh("Resources/tuktuk.obj") };
 
 	//Initialize Camera
 	m_Camera.Initialize({ float(m_Width) / float(m_Height) }, 45.f, { 0, 0, 0 });
 
-	std::vector<Vertex> vertices{};
-	std::vector<uint32_t> indices{};
-
-	Utils::ParseOBJ("Resources/vehicle.obj", vertices, indices);
+	//a map that failed to load is replaced by a single texel that leaves the shading neutral, the renderer still starts
+	const auto getTexture{ [](const std::shared_future<TextureHandle>& texture, const char* name, uint32_t placeholderTexel)
+		{
+			TextureHandle pTexture{ texture.get() };
+			if (!pTexture)
+			{
+				std::cout << "Failed to load " << name << ", using a placeholder" << std::endl;
+				pTexture.reset(Texture::CreateSolid(placeholderTexel));
+			}
+			return pTexture;
+		} };
 
-	//Utils::ParseOBJ("Resources/tuktuk.obj", vertices, indices);
+	m_pTexture = getTexture(tuktukTexture, "tuktuk.png", 0xFFFFFFFF);
 
-	//define mesh
-	std::vector<Mesh> meshes_world
+	//the vehicle maps are only needed to bake the material, that overlaps with the mesh still loading
+	//their handles go out of scope right after, so ReleaseUnused below can evict them
 	{
-		//vehicle
-		Mesh{
-			vertices,
-			indices,
-			PrimitiveTopology::TriangleList,
-			{}, //vertices out
+		//white diffuse, flat normal, no specular, no gloss
+		const TextureHandle pDiffuse{ getTexture(diffuseMap, "vehicle_diffuse.png", 0xFFFFFFFF) };
+		const TextureHandle pNormal{ getTexture(normalMap, "vehicle_normal.png", 0xFFFF8080) };
+		const TextureHandle pSpecular{ getTexture(specularMap, "vehicle_specular.png", 0xFF000000) };
+		const TextureHandle pGloss{ getTexture(glossMap, "vehicle_gloss.png", 0xFF000000) };
+		m_pMaterial = Material::Bake(*pDiffuse, *pNormal, *pSpecular, *pGloss, m_MaterialFormat);
+	}
 
-			{ //world matrix
-				{1, 0, 0, 0},
-				{0, 1, 0, 0},
-				{0, 0, 1, 0},
-				{0, 0, 0, 1}
-			}
-		}
+	//a mesh that failed to load is left out of the scene
+	const GeometryHandle pVehicle{ vehicleMesh.get() };
+	if (!pVehicle)
+		std::cout << "Failed to load vehicle.obj, the scene stays empty" << std::endl;
+	m_pTuktukMesh = tuktukMesh.get();
+	if (!m_pTuktukMesh)
+		std::cout << "Failed to load tuktuk.obj" << std::endl;
 
-		//tuktuk
-		/*Mesh{
-			vertices,
-			indices,
-			PrimitiveTopology::TriangleList,
-		}*/
-	};
+	//nothing holds on to the vehicle maps anymore
+	m_pAssets->ReleaseUnused();
+
+	//define scene
+	m_pScene = new Scene();
 
-	m_Meshes = meshes_world;
+	//vehicle
+	if (pVehicle)
+		m_VehicleId = m_pScene->AddInstance(pVehicle, Matrix{});
+
+	//tuktuk
+	/*m_pScene->AddInstance(pTuktuk, Matrix{});*/
+
+	CreateLocalLights(256);
 }
 
 Renderer::~Renderer()
 {
-	delete m_pTexture;
+	//vertex stages still running as jobs read the frames and their geometry
+	for (FrameData& frame : m_Frames)
+		m_pJobs->Wait(frame.vertexStage);
+
+	//the last frames are still shown before the back buffers go
+	delete m_pPresenter;
+	m_pPresenter = nullptr;
+	m_pBackBuffer = nullptr;
+
 	m_pTexture = nullptr;
 
-	delete m_pNormal;
-	m_pNormal = nullptr;
+	delete m_pMaterial;
+	m_pMaterial = nullptr;
 
-	delete m_pDiffuse;
-	m_pDiffuse = nullptr;
+	delete m_pScene;
+	m_pScene = nullptr;
 
-	delete m_pGloss;
-	m_pGloss = nullptr;
+	delete m_pAssets;
+	m_pAssets = nullptr;
 
-	delete m_pSpecular;
-	m_pSpecular = nullptr;
+	delete m_pHDRBuffer;
+	m_pHDRBuffer = nullptr;
+
+	delete m_pGBuffer;
+	m_pGBuffer = nullptr;
+
+	delete m_pShadowMap;
+	m_pShadowMap = nullptr;
 
 	delete[] m_pDepthBufferPixels;
+
+	//last, queued jobs still run before the workers stop
+	delete m_pJobs;
+	m_pJobs = nullptr;
 }
 
 void Renderer::Update(Timer* pTimer)
 {
 	m_Camera.Update(pTimer);
 	m_RotationAngle += 0.0174533 / pTimer->GetElapsed();
+
+	//moving an object only refits the scene hierarchy, it does not rebuild it
+	if (m_VehicleId != SIZE_MAX)
+		m_pScene->SetWorldMatrix(m_VehicleId, Matrix::CreateRotationY(m_RotationAngle) * Matrix::CreateTranslation(0, 0, 50.f));
+
+	UpdateLocalLights(pTimer->GetElapsed());
 }
 
 void Renderer::Render()
 {
 	//@START
+	const std::chrono::steady_clock::time_point renderStart{ std::chrono::steady_clock::now() };
+
+	//the vertex stage of this frame starts first, with render-ahead it overlaps the raster stage of an older frame below
+	BeginFrame();
+
+	//frames that no longer fit after the render-ahead was lowered are dropped
+	while (m_StartedFrames - m_RasterizedFrames > uint64_t(m_RenderAhead) + 1)
+	{
+		FrameData& droppedFrame{ m_Frames[m_RasterizedFrames++ % m_Frames.size()] };
+		m_pJobs->Wait(droppedFrame.vertexStage);
+		droppedFrame.vertexStage = {};
+	}
+
+	//nothing to show while the pipeline fills up
+	if (m_StartedFrames - m_RasterizedFrames <= uint64_t(m_RenderAhead))
+		return;
+
+	FrameData& frame{ m_Frames[m_RasterizedFrames++ % m_Frames.size()] };
+	m_pJobs->Wait(frame.vertexStage);
+	frame.vertexStage = {};
+
+	//the fence, waits while this buffer still holds the frame before the last one
+	//the wait does not get shorter at a lower resolution, it is left out of the render time
+	const std::chrono::steady_clock::time_point fenceStart{ std::chrono::steady_clock::now() };
+	m_pBackBuffer = m_pPresenter->AcquireBackBuffer();
+	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
+	const std::chrono::steady_clock::duration fenceTime{ std::chrono::steady_clock::now() - fenceStart };
+
+	//the targets follow the resolution of the frame, the back buffer holds its image packed at the start
+	m_RenderWidth = frame.width;
+	m_RenderHeight = frame.height;
+	m_pHDRBuffer->Resize(frame.width, frame.height, frame.sampleCount);
+	m_pGBuffer->Resize(frame.width, frame.height);
+
 	//Lock BackBuffer
 	SDL_LockSurface(m_pBackBuffer);
 	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
 	
-	for (int i = 0; i < m_Width * m_Height; ++i)
+	for (int i = 0; i < frame.width * frame.height * frame.sampleCount; ++i)
 		m_pDepthBufferPixels[i] = FLT_MAX;
 
 	//RENDER LOGIC
@@ -119,13 +207,21 @@ void Renderer::Render()
 	//Render_W3_Part1();
 	//Render_W3_Part2();
 
-	Render_W4_Part1();
+	if (frame.isUsingDeferredShading)
+		Render_W4_Part2(frame);
+	else
+		Render_W4_Part1(frame);
 
 	//@END
 	//Update SDL Surface
 	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
-	SDL_UpdateWindowSurface(m_pWindow);
+
+	//blit, upscale and window update happen on the present thread while the next frame renders
+	m_pPresenter->Present(frame.width, frame.height);
+
+	const std::chrono::duration<float> renderTime{ std::chrono::steady_clock::now() - renderStart - fenceTime };
+	if (m_IsUsingDynamicResolution)
+		m_ResolutionScaler.AddFrameTime(renderTime.count());
 }
 
 void Renderer::Render_W1_Part1() //rasterization stage
@@ -1105,17 +1201,17 @@ void Renderer::Render_W3_Part1() //depth interpolation
 }
 void Renderer::Render_W3_Part2() //depth interpolation
 {
+	if (!m_pTuktukMesh)
+		return;
+
 	ColorRGB finalColor{};
 
-	std::vector<Vertex> vertices{};
-	std::vector<uint32_t> indices{};
-	Utils::ParseOBJ("Resources/tuktuk.obj", vertices, indices);
-	//define mesh
+	//define mesh, the geometry was loaded once by the asset cache
 	std::vector<Mesh> meshes_world
 	{
 		Mesh{
-			vertices,
-			indices,
+			m_pTuktukMesh->vertices,
+			m_pTuktukMesh->indices,
 			PrimitiveTopology::TriangleList,
 		}
 	};
@@ -1229,142 +1325,373 @@ void Renderer::Render_W3_Part2() //depth interpolation
 	}
 }
 
-void Renderer::Render_W4_Part1() //shading
+void Renderer::Render_W4_Part1(const FrameData& frame) //shading
 {
-	ColorRGB finalColor{};
+	m_pHDRBuffer->Clear(m_ClearColor);
+	UpdateShadowMap(frame);
 
-	//projection stage -> convert all the vertices to NDC
-	VertexTransformationFunction(m_Meshes);
+	if (frame.isUsingLocalLights)
+	{
+		//depth prepass, the light grid needs the depth range of every tile before anything is shaded
+		const DrawFunction drawDepth{ frame.isUsingNormalMap ? &Renderer::DrawDepth<true> : &Renderer::DrawDepth<false> };
+		for (size_t drawIdx{ 0 }; drawIdx < frame.renderQueue.size(); ++drawIdx)
+			(this->*drawDepth)(frame, drawIdx);
 
-	//for every mesh
-	for (const auto& mesh : m_Meshes)
+		m_LightGrid.Build(frame.lights, m_pDepthBufferPixels, frame.width, frame.height, frame.sampleCount, frame.camera.viewMatrix, frame.camera.projectionMatrix);
+	}
+
+	DrawRenderQueue(frame);
+
+	m_pHDRBuffer->Resolve(*m_pJobs, m_pBackBufferPixels, m_PixelFormat, m_ToneMapping);
+}
+
+void Renderer::Render_W4_Part2(const FrameData& frame) //deferred shading
+{
+	m_pHDRBuffer->Clear(m_ClearColor);
+	UpdateShadowMap(frame);
+
+	//geometry pass, only the nearest surface of every pixel is left in the g-buffer
+	m_pGBuffer->Clear();
+	DrawRenderQueue(frame);
+
+	if (frame.isUsingLocalLights)
+		m_LightGrid.Build(frame.lights, m_pGBuffer->GetDepth(), frame.width, frame.height, 1, frame.camera.viewMatrix, frame.camera.projectionMatrix);
+
+	//lighting pass
+	(this->*SelectShadeFunction(frame))(frame);
+
+	m_pHDRBuffer->Resolve(*m_pJobs, m_pBackBufferPixels, m_PixelFormat, m_ToneMapping);
+}
+
+void Renderer::BeginFrame()
+{
+	//render-ahead + 1 frames are in flight at most, the slot of this one is free again
+	FrameData& frame{ m_Frames[m_StartedFrames++ % m_Frames.size()] };
+
+	//a lower resolution than the window when the render time runs over the target
+	frame.width = m_Width;
+	frame.height = m_Height;
+	if (m_IsUsingDynamicResolution)
+		m_ResolutionScaler.GetRenderSize(m_Width, m_Height, frame.width, frame.height);
+
+	UpdateLightingConstants();
+	frame.camera = m_Camera;
+	frame.lighting = m_Lighting;
+	frame.lights = m_Lights;
+	BuildRenderQueue(frame.renderQueue);
+	SelectShadingRates(frame);
+
+	//every instance the light sees casts, also the ones outside the view of the camera
+	frame.isDrawingShadowMap = m_IsUsingShadows && m_pShadowMap->NextFrame();
+	frame.shadowCasters.clear();
+	if (frame.isDrawingShadowMap)
 	{
-		//all the converted vertices
-		std::vector<Vertex_Out> vertices = mesh.vertices_out;
+		frame.sceneBounds = m_pScene->GetBounds();
+		if (frame.sceneBounds.IsValid())
+		{
+			for (const MeshInstance* pInstance : m_pScene->GetVisibleInstances(m_pShadowMap->GetFrustum(m_Lighting.lightDirection, frame.sceneBounds)))
+				frame.shadowCasters.push_back(*pInstance);
+		}
+	}
 
-		for (size_t i = 0; i < mesh.indices.size() - 2; ++i)
+	frame.shadingMode = m_ShadingMode;
+	frame.isUsingNormalMap = m_IsUsingNormalMap;
+	frame.isShowingTexture = m_IsShowingTexture;
+	frame.isUsingLocalLights = m_IsUsingLocalLights;
+	frame.isUsingShadows = m_IsUsingShadows;
+	frame.isUsingDeferredShading = m_IsUsingDeferredShading;
+	frame.sampleCount = m_IsUsingMSAA && !m_IsUsingDeferredShading ? HDRBuffer::multiSampleCount : 1;
+
+	const VertexStageFunction shadeVertices{ SelectVertexStageFunction(frame) };
+	if (m_RenderAhead == 0)
+		(this->*shadeVertices)(frame);
+	else
+		frame.vertexStage = m_pJobs->Schedule([this, shadeVertices, &frame]() { (this->*shadeVertices)(frame); });
+}
+
+void Renderer::BuildRenderQueue(std::vector<MeshInstance>& renderQueue)
+{
+	//only the instances that are (partially) inside the frustum go through the pipeline
+	const std::vector<MeshInstance*>& visibleInstances{ m_pScene->GetVisibleInstances(m_Camera.GetFrustum()) };
+
+	//level of detail, instances that would only cover a pixel or so are dropped here
+	//copied, the scene is free to move them while the frame is still on its way through the pipeline
+	renderQueue.clear();
+	for (MeshInstance* pInstance : visibleInstances)
+	{
+		if (SelectLOD(*pInstance))
+			renderQueue.push_back(*pInstance);
+	}
+
+	//instanced draws keep the lod they were given, they are only culled against the frustum
+	const Frustum frustum{ m_Camera.GetFrustum() };
+	for (const MeshInstance& instance : m_InstancedDraws)
+	{
+		if (frustum.Test(instance.pGeometry->bounds.Transformed(instance.worldMatrix)) != Containment::outside)
+			renderQueue.push_back(instance);
+	}
+	m_InstancedDraws.clear();
+
+	//instances that share geometry and lod end up next to each other
+	std::sort(renderQueue.begin(), renderQueue.end(), [](const MeshInstance& a, const MeshInstance& b)
 		{
-			//define the triangle
-			//----------------------------------------------------------------------------------------------------
-			// USING TRIANGLE LIST
-			//----------------------------------------------------------------------------------------------------			
-			Vertex_Out vertex1{ vertices[mesh.indices[i]] };
-			Vertex_Out vertex2{ vertices[mesh.indices[++i]] };
-			Vertex_Out vertex3{ vertices[mesh.indices[++i]] };
-			//----------------------------------------------------------------------------------------------------
-			//----------------------------------------------------------------------------------------------------
+			if (a.pGeometry != b.pGeometry)
+				return std::less<const MeshGeometry*>{}(a.pGeometry.get(), b.pGeometry.get());
+			return a.lodIdx < b.lodIdx;
+		});
+}
 
-			//check if the vertices are inside the frustum
-			if (!FrustumCulling(vertex1) || !FrustumCulling(vertex2) || !FrustumCulling(vertex3))
-				continue;
+void Renderer::SelectShadingRates(FrameData& frame)
+{
+	frame.shadingRates.assign(frame.renderQueue.size(), m_ShadingRate);
+	if (!m_IsUsingAutomaticShadingRate)
+		return;
 
-			//rasterization stage
-			//convert the points to raster space
-			ConvertToRasterSpace(vertex1);
-			ConvertToRasterSpace(vertex2);
-			ConvertToRasterSpace(vertex3);
+	if (m_PreviousScreenTransforms.size() < m_pScene->GetObjectCount())
+		m_PreviousScreenTransforms.resize(m_pScene->GetObjectCount());
 
-			//edges
-			const Vector2 v1 { vertex1.position.x, vertex1.position.y };
-			const Vector2 v2 { vertex2.position.x, vertex2.position.y };
-			const Vector2 v3 { vertex3.position.x, vertex3.position.y };
-			const Vector2 v1v2{ v2 - v1 };
-			const Vector2 v2v3{ v3 - v2 };
-			const Vector2 v3v1{ v1 - v3 };
+	for (size_t drawIdx{ 0 }; drawIdx < frame.renderQueue.size(); ++drawIdx)
+	{
+		const MeshInstance& instance{ frame.renderQueue[drawIdx] };
 
-			Vector2 topLeft{ std::min(v3.x, std::min(v1.x, v2.x)), std::min(v3.y, std::min(v1.y, v2.y)) };
-			Vector2 bottomRight{ std::max(v3.x, std::max(v1.x, v2.x)), std::max(v3.y, std::max(v1.y, v2.y)) };
+		//instanced draws are not tracked from frame to frame, with nothing to compare with they are shaded at the full rate
+		if (instance.objectId >= m_PreviousScreenTransforms.size())
+		{
+			frame.shadingRates[drawIdx] = ShadingRate::full;
+			continue;
+		}
 
-			topLeft.x = Clamp(topLeft.x, 1.f, m_Width - 1.f);
-			topLeft.y = Clamp(topLeft.y, 1.f, m_Height - 1.f);
-			bottomRight.x = Clamp(ceilf(bottomRight.x), 1.f, m_Width - 1.f);
-			bottomRight.y = Clamp(ceilf(bottomRight.y), 1.f, m_Height - 1.f);
+		const Matrix worldViewProjection{ instance.worldMatrix * frame.camera.viewMatrix * frame.camera.projectionMatrix };
+		ScreenTransform& previous{ m_PreviousScreenTransforms[instance.objectId] };
 
-			for (int px{ int(topLeft.x) }; px <= int(bottomRight.x); ++px)
+		//the fastest corner of the bounds in pixels per frame, the camera moving counts as well
+		//an object that was not drawn in the frame before has nothing to compare with and is shaded at the full rate
+		float velocity{};
+		if (previous.frame + 1 == m_StartedFrames)
+		{
+			const BoundingBox& bounds{ instance.pGeometry->bounds };
+			for (int corner{ 0 }; corner < 8; ++corner)
 			{
-				for (int py{ int(topLeft.y) }; py <= int(bottomRight.y); ++py)
-				{
-					//pixel position
-					Vector2 position{ float(px), float(py) };
+				const Vector4 point{ corner & 1 ? bounds.max.x : bounds.min.x, corner & 2 ? bounds.max.y : bounds.min.y, corner & 4 ? bounds.max.z : bounds.min.z, 1.f };
+				const Vector4 position{ worldViewProjection.TransformPoint(point) };
+				const Vector4 previousPosition{ previous.worldViewProjection.TransformPoint(point) };
+				if (position.w <= 0.f || previousPosition.w <= 0.f)
+					continue;
+
+				const Vector2 offset{ (position.x / position.w - previousPosition.x / previousPosition.w) * frame.width * 0.5f,
+					(position.y / position.w - previousPosition.y / previousPosition.w) * frame.height * 0.5f };
+				velocity = std::max(velocity, offset.Magnitude());
+			}
+		}
+		previous = { worldViewProjection, m_StartedFrames };
+
+		if (velocity >= coarsestVelocity)
+			frame.shadingRates[drawIdx] = ShadingRate::coarse4x4;
+		else if (velocity >= coarseVelocity)
+			frame.shadingRates[drawIdx] = ShadingRate::coarse2x2;
+		else
+			frame.shadingRates[drawIdx] = ShadingRate::full;
+	}
+}
 
-					//cross of vertex to pixel and vertex
-					auto signedArea1{ Vector2::Cross(v1v2, position - v1) };
-					auto signedArea2{ Vector2::Cross(v2v3, position - v2) };
-					auto signedArea3{ Vector2::Cross(v3v1, position - v3) };
+void Renderer::DrawInstanced(const GeometryHandle& pGeometry, std::span<const Matrix> worldMatrices, int lodIdx)
+{
+	if (!pGeometry)
+		return;
 
-					//if pixel is in triangle
-					if (signedArea1 >= 0 && signedArea2 >= 0 && signedArea3 >= 0)
-					{
-						//view space
-						float totalArea{ Vector2::Cross(v3v1, v1v2) / 2 };
+	lodIdx = std::clamp(lodIdx, 0, int(pGeometry->lods.size()));
+	for (const Matrix& worldMatrix : worldMatrices)
+		m_InstancedDraws.push_back({ pGeometry, worldMatrix, lodIdx });
+}
 
-						//weights
-						float w1 = std::abs({ Vector2::Cross(v2v3, position - v2) / 2 / totalArea });
-						float w2 = std::abs({ Vector2::Cross(v3v1, position - v3) / 2 / totalArea });
-						float w3 = std::abs({ Vector2::Cross(v1v2, position - v1) / 2 / totalArea });
+void Renderer::DrawRenderQueue(const FrameData& frame)
+{
+	//the state the pixels branch on is picked once per frame, not per fragment
+	const DrawFunction draw{ SelectDrawFunction(frame) };
+	for (size_t drawIdx{ 0 }; drawIdx < frame.renderQueue.size(); ++drawIdx)
+		(this->*draw)(frame, drawIdx);
+}
 
-						float depth{ 1 / ((w1 / vertex1.position.z) + (w2 / vertex2.position.z) + (w3 / vertex3.position.z)) };
+void Renderer::UpdateLightingConstants()
+{
+	const float lightIntensity{ 7.f };
+	m_Lighting.lightDirection = Vector3{ 0.577f, -0.577f, 0.577f }.Normalized();
+	m_Lighting.diffuseScale = lightIntensity / float(M_PI);
+	m_Lighting.shininess = 25.f;
+	m_Lighting.ambient = { 0.025f, 0.025f, 0.025f };
+	m_Lighting.cameraOrigin = m_Camera.origin;
+}
 
-						int currentPixel{ px + py * m_Width };
-						if (currentPixel < m_Width * m_Height)
-						{
-							//frustum clipping
-							if (depth > 0 && depth < 1)
-							{
-								if (depth < m_pDepthBufferPixels[currentPixel])
-								{
-									m_pDepthBufferPixels[currentPixel] = depth;
+void Renderer::UpdateShadowMap(const FrameData& frame)
+{
+	if (!frame.isDrawingShadowMap)
+		return;
 
-									float w{ 1 / ((w1 / vertex1.position.w) + (w2 / vertex2.position.w) + (w3 / vertex3.position.w)) };
-									auto uv = ((vertex1.uv / vertex1.position.w) * w1 + (vertex2.uv / vertex2.position.w) * w2 + (vertex3.uv / vertex3.position.w) * w3) * w;
+	m_pShadowMap->Begin(frame.lighting.lightDirection, frame.sceneBounds);
+	for (const MeshInstance& caster : frame.shadowCasters)
+		m_pShadowMap->DrawCaster(caster.pGeometry->GetLODVertices(caster.lodIdx), caster.pGeometry->GetLODIndices(caster.lodIdx), caster.worldMatrix);
+}
 
-									Vector3 normal{ ((vertex1.normal / vertex1.position.w) * w1 + (vertex2.normal / vertex2.position.w) * w2 + (vertex3.normal / vertex3.position.w) * w3) * w };
-									const Vector3 tangent{ ((vertex1.tangent / vertex1.position.w) * w1 + (vertex2.tangent / vertex2.position.w) * w2 + (vertex3.tangent / vertex3.position.w) * w3) * w };
-									const Vector3 viewDir{ ((vertex1.viewDirection / vertex1.position.w) * w1 + (vertex2.viewDirection / vertex2.position.w) * w2 + (vertex3.viewDirection / vertex3.position.w) * w3) * w };
-									const Vector4 position{ ((vertex1.position * w1) + (vertex2.position * w2) + (vertex3.position * w3)) * w };
-																	
-									if (m_IsUsingNormalMap)
-									{
-										const Vector3 binormal{ Vector3::Cross(normal, tangent)};
-										const Matrix tangentSpaceAxis{ Matrix{tangent, binormal, normal, Vector3::Zero} };
-										ColorRGB sampledNormal{ m_pNormal->Sample(uv) };		
-										sampledNormal = 2.f * sampledNormal - ColorRGB{1, 1, 1};
-										normal = tangentSpaceAxis.TransformVector({ sampledNormal.r, sampledNormal.g, sampledNormal.b });
-									}
+void Renderer::CreateLocalLights(int count)
+{
+	//scattered around the vehicle, a fifth of them spots aimed at its center
+	std::mt19937 generator{ 7 };
+	std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+	const auto random{ [&](float min, float max) { return min + (max - min) * unit(generator); } };
 
-									Vertex_Out pixel;
-									pixel.position = position;
-									pixel.uv = uv;
-									pixel.tangent = tangent;
-									pixel.normal = normal;
-									pixel.viewDirection = viewDir;		
-									pixel.color = m_pDiffuse->Sample(uv);
+	m_LightRig.clear();
+	for (int lightIdx{ 0 }; lightIdx < count; ++lightIdx)
+	{
+		Light light{};
+		light.position = { random(-24.f, 24.f), random(-10.f, 12.f), random(-20.f, 20.f) };
+		light.color = { random(0.2f, 1.f), random(0.2f, 1.f), random(0.2f, 1.f) };
 
-									if (m_IsShowingTexture)
-										pixel.color = m_pDiffuse->Sample(uv);
-									else
-									{
-										depth = Remap(depth);
-										pixel.color = { depth, depth, depth };
-									}
-						
-									finalColor = PixelShading(&pixel);									
-									
-									//Update Color in Buffer
-									m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-										static_cast<uint8_t>(finalColor.r * 255),
-										static_cast<uint8_t>(finalColor.g * 255),
-										static_cast<uint8_t>(finalColor.b * 255));
-								}
-							}
-						}
-					}
-				}
-			}
+		if (lightIdx % 5 == 0)
+		{
+			light.type = LightType::spot;
+			light.direction = (-light.position).Normalized();
+			light.range = 20.f;
+			light.intensity = random(60.f, 120.f);
+			light.cosOuterAngle = cosf(20.f * TO_RADIANS);
+			light.cosInnerAngle = cosf(12.f * TO_RADIANS);
 		}
+		else
+		{
+			light.range = random(3.f, 7.f);
+			light.intensity = random(8.f, 20.f);
+		}
+		m_LightRig.push_back(light);
+	}
+	m_Lights = m_LightRig;
+}
+
+void Renderer::UpdateLocalLights(float deltaTime)
+{
+	//the whole rig circles the vehicle
+	m_LightAngle += 0.5f * deltaTime;
+	const Matrix transform{ Matrix::CreateRotationY(m_LightAngle) * Matrix::CreateTranslation(0, 0, 50.f) };
+	for (size_t lightIdx{ 0 }; lightIdx < m_LightRig.size(); ++lightIdx)
+	{
+		m_Lights[lightIdx].position = transform.TransformPoint(m_LightRig[lightIdx].position);
+		m_Lights[lightIdx].direction = transform.TransformVector(m_LightRig[lightIdx].direction);
+	}
+}
+
+Renderer::DrawFunction Renderer::SelectDrawFunction(const FrameData& frame) const
+{
+	//indexed by shading mode, normal map, texture, local lights and shadows
+	static constexpr DrawVariants variants[]{
+		GetDrawVariants<ShadingMode::observedArea>(),
+		GetDrawVariants<ShadingMode::diffuse>(),
+		GetDrawVariants<ShadingMode::specular>(),
+		GetDrawVariants<ShadingMode::combined>()
+	};
+	static constexpr std::array<std::array<DrawFunction, 2>, 2> gBufferVariants{ GetGBufferDrawVariants() };
+
+	if (frame.isUsingDeferredShading)
+		return gBufferVariants[frame.isUsingNormalMap][frame.isShowingTexture];
+	return variants[int(frame.shadingMode)][frame.isUsingNormalMap][frame.isShowingTexture][frame.isUsingLocalLights][frame.isUsingShadows];
+}
+
+Renderer::ShadeFunction Renderer::SelectShadeFunction(const FrameData& frame) const
+{
+	//indexed by shading mode, texture, local lights and shadows
+	static constexpr ShadeVariants variants[]{
+		GetShadeVariants<ShadingMode::observedArea>(),
+		GetShadeVariants<ShadingMode::diffuse>(),
+		GetShadeVariants<ShadingMode::specular>(),
+		GetShadeVariants<ShadingMode::combined>()
+	};
+	return variants[int(frame.shadingMode)][frame.isShowingTexture][frame.isUsingLocalLights][frame.isUsingShadows];
+}
+
+Renderer::VertexStageFunction Renderer::SelectVertexStageFunction(const FrameData& frame) const
+{
+	//indexed by normal map and world position, the deferred pass rebuilds the world position from the depth
+	static constexpr VertexStageFunction variants[2][2]{
+		{ &Renderer::ShadeVertices<false, false>, &Renderer::ShadeVertices<false, true> },
+		{ &Renderer::ShadeVertices<true, false>, &Renderer::ShadeVertices<true, true> }
+	};
+
+	const bool isUsingWorldPosition{ !frame.isUsingDeferredShading && (frame.isUsingLocalLights || frame.isUsingShadows) };
+	return variants[frame.isUsingNormalMap][isUsingWorldPosition];
+}
+
+template<bool isUsingNormalMap, bool isUsingWorldPosition>
+void Renderer::ShadeVertices(FrameData& frame) const
+{
+	using VertexShader = PhongVertexShader<isUsingNormalMap, isUsingWorldPosition>;
+	FrameData::DrawVertices<VertexShader>& drawVertices{ std::get<FrameData::DrawVertices<VertexShader>>(frame.vertices) };
+	drawVertices.resize(frame.renderQueue.size());
+
+	for (size_t drawIdx{ 0 }; drawIdx < frame.renderQueue.size(); ++drawIdx)
+	{
+		const MeshInstance& instance{ frame.renderQueue[drawIdx] };
+
+		VertexShader vertexShader{};
+		vertexShader.worldMatrix = instance.worldMatrix;
+		vertexShader.worldViewProjectionMatrix = instance.worldMatrix * frame.camera.viewMatrix * frame.camera.projectionMatrix;
+		vertexShader.cameraOrigin = frame.camera.origin;
+
+		Pipeline<VertexShader>::ShadeVertices(*m_pJobs, vertexShader, instance.pGeometry->GetLODVertices(instance.lodIdx), frame.width, frame.height, drawVertices[drawIdx]);
 	}
 }
 
+template<bool isUsingNormalMap>
+void Renderer::DrawDepth(const FrameData& frame, size_t drawIdx)
+{
+	using VertexShader = PhongVertexShader<isUsingNormalMap, true>;
+	const MeshInstance& instance{ frame.renderQueue[drawIdx] };
+
+	const RenderTarget target{ m_pHDRBuffer, m_pDepthBufferPixels, frame.width, frame.height, frame.sampleCount };
+	Pipeline<VertexShader>::template RasterizeTriangles<std::nullptr_t>(*m_pJobs, nullptr, std::get<FrameData::DrawVertices<VertexShader>>(frame.vertices)[drawIdx],
+		instance.pGeometry->GetLODIndices(instance.lodIdx), target, DepthTest::less);
+}
+
+template<ShadingMode shadingMode, bool isUsingNormalMap, bool isShowingTexture, bool isUsingLocalLights, bool isUsingShadows>
+void Renderer::DrawPhong(const FrameData& frame, size_t drawIdx)
+{
+	using PixelShader = PhongPixelShader<shadingMode, isUsingNormalMap, isShowingTexture, isUsingLocalLights, isUsingShadows>;
+	using VertexShader = PhongVertexShader<isUsingNormalMap, PixelShader::isUsingWorldPosition>;
+	const MeshInstance& instance{ frame.renderQueue[drawIdx] };
+
+	PixelShader pixelShader{};
+	pixelShader.pMaterial = m_pMaterial;
+	pixelShader.sampler = m_Sampler;
+	pixelShader.lighting = { frame.lighting, &m_LightGrid, m_pShadowMap };
+
+	//after a depth prepass only the nearest surface passes, every pixel is shaded once
+	const DepthTest depthTest{ isUsingLocalLights ? DepthTest::lessEqual : DepthTest::less };
+
+	const RenderTarget target{ m_pHDRBuffer, m_pDepthBufferPixels, frame.width, frame.height, frame.sampleCount };
+	Pipeline<VertexShader>::RasterizeTriangles(*m_pJobs, &pixelShader, std::get<FrameData::DrawVertices<VertexShader>>(frame.vertices)[drawIdx],
+		instance.pGeometry->GetLODIndices(instance.lodIdx), target, depthTest, frame.shadingRates[drawIdx]);
+}
+
+template<bool isUsingNormalMap, bool isShowingTexture>
+void Renderer::DrawGBuffer(const FrameData& frame, size_t drawIdx)
+{
+	using VertexShader = PhongVertexShader<isUsingNormalMap, false>;
+	const MeshInstance& instance{ frame.renderQueue[drawIdx] };
+
+	PhongGBufferPixelShader<isUsingNormalMap, isShowingTexture> pixelShader{};
+	pixelShader.pMaterial = m_pMaterial;
+	pixelShader.sampler = m_Sampler;
+	pixelShader.pGBuffer = m_pGBuffer;
+
+	const RenderTarget target{ m_pHDRBuffer, m_pGBuffer->GetDepth(), frame.width, frame.height };
+	Pipeline<VertexShader>::RasterizeTriangles(*m_pJobs, &pixelShader, std::get<FrameData::DrawVertices<VertexShader>>(frame.vertices)[drawIdx],
+		instance.pGeometry->GetLODIndices(instance.lodIdx), target, DepthTest::less);
+}
+
+template<ShadingMode shadingMode, bool isShowingTexture, bool isUsingLocalLights, bool isUsingShadows>
+void Renderer::ShadeGBuffer(const FrameData& frame)
+{
+	const PhongLighting<shadingMode, isUsingLocalLights, isUsingShadows> lighting{ frame.lighting, &m_LightGrid, m_pShadowMap };
+	const RenderTarget target{ m_pHDRBuffer, m_pGBuffer->GetDepth(), frame.width, frame.height };
+	dae::ShadeGBuffer<shadingMode, isShowingTexture, isUsingLocalLights, isUsingShadows>(*m_pJobs, *m_pGBuffer, lighting, frame.camera.invViewMatrix, frame.camera.projectionMatrix, target);
+}
+
 bool Renderer::FrustumCulling(const Vertex_Out& vertex)
 {
 	//check if vertices are inside the frustum [-1, 1] for x and y, [near, far] for z
@@ -1383,85 +1710,234 @@ void dae::Renderer::ConvertToRasterSpace(Vertex_Out& vertex)
 	vertex.position.y = ((1 - vertex.position.y) / 2) * m_Height;
 }
 
-ColorRGB dae::Renderer::PixelShading(Vertex_Out* vertex)
+void dae::Renderer::CycleTexture()
 {
-	ColorRGB finalColor{};
-	Vector3 lightDirection = Vector3{ 0.577f, -0.577f, 0.577f }.Normalized();
-	const float lambertLaw{ Saturate(Vector3::Dot(vertex->normal, -lightDirection)) };
-	float lightIntensity{ 7.f };
-	float shininess{ 25.f };
-	ColorRGB ambient{ 0.025f, 0.025f, 0.025f };
-	ColorRGB specularColor{ m_pSpecular->Sample(vertex->uv) };
-	ColorRGB phongExponent{ m_pGloss->Sample(vertex->uv) * shininess };
-
-	//observed area
-	ColorRGB observedArea{ lambertLaw, lambertLaw, lambertLaw };
+	m_IsShowingTexture = !m_IsShowingTexture;
+}
 
-	//lambert
-	ColorRGB lambert{ (lambertLaw * vertex->color * lightIntensity) / float(M_PI) };
+void dae::Renderer::ToggleRotation()
+{
+	m_IsRotating = !m_IsRotating;
+}
 
-	//phong
-	const Vector3 reflect{ Vector3::Reflect(vertex->normal, -lightDirection) };
-	const float cosine{ std::max(0.f, Vector3::Dot(reflect, vertex->viewDirection)) };
-	const auto phong{ specularColor * powf(cosine, phongExponent.r) };
+void dae::Renderer::ToggleNormalMap()
+{
+	m_IsUsingNormalMap = !m_IsUsingNormalMap;
+}
 
+void dae::Renderer::CycleShadingMode()
+{
 	switch (m_ShadingMode)
 	{
 	case ShadingMode::combined:
-		finalColor = { ambient + (lambert * observedArea) + phong };
+		m_ShadingMode = ShadingMode::observedArea;
 		break;
 	case ShadingMode::observedArea:
-		finalColor = observedArea;
+		m_ShadingMode = ShadingMode::diffuse;
 		break;
 	case ShadingMode::diffuse:
-		finalColor = observedArea * lambert;
+		m_ShadingMode = ShadingMode::specular;
 		break;
 	case ShadingMode::specular:
-		finalColor = phong;
+		m_ShadingMode = ShadingMode::combined;
 		break;
 	}
+}
 
-	finalColor.MaxToOne();
-	return finalColor;
+void dae::Renderer::CycleLODErrorBudget()
+{
+	//0.5 -> 1 -> 2 -> 4 -> 8 -> back to 0.5 pixels
+	m_LODErrorBudget *= 2.f;
+	if (m_LODErrorBudget > 8.f)
+		m_LODErrorBudget = 0.5f;
 }
 
-void dae::Renderer::CycleTexture()
+void dae::Renderer::PrintAssetMemory() const
 {
-	m_IsShowingTexture = !m_IsShowingTexture;
+	std::cout << "--- Assets ---" << std::endl;
+	for (const AssetCache::AssetInfo& info : m_pAssets->GetMemoryReport())
+		std::cout << info.key << ": " << info.sizeInBytes / 1024 << " KB, " << info.useCount << " handle(s)" << std::endl;
+
+	std::cout << "Material: " << m_pMaterial->GetSizeInBytes() / 1024 << " KB" << std::endl;
+	std::cout << "Total: " << (m_pAssets->GetTotalSizeInBytes() + m_pMaterial->GetSizeInBytes()) / 1024 << " KB" << std::endl;
 }
 
-void dae::Renderer::ToggleRotation()
+void dae::Renderer::ToggleLocalLights()
 {
-	m_IsRotating = !m_IsRotating;
+	m_IsUsingLocalLights = !m_IsUsingLocalLights;
+	std::cout << (m_IsUsingLocalLights ? "local lights on, " : "local lights off, ") << m_Lights.size() << " lights\n";
 }
 
-void dae::Renderer::ToggleNormalMap()
+void dae::Renderer::ToggleDeferredShading()
 {
-	m_IsUsingNormalMap = !m_IsUsingNormalMap;
+	m_IsUsingDeferredShading = !m_IsUsingDeferredShading;
+	std::cout << (m_IsUsingDeferredShading ? "deferred shading\n" : "forward shading\n");
 }
 
-void dae::Renderer::CycleShadingMode()
+void dae::Renderer::CycleShadows()
 {
-	switch (m_ShadingMode)
+	//off, every frame, every 4th frame, static
+	if (!m_IsUsingShadows)
 	{
-	case ShadingMode::combined:
-		m_ShadingMode = ShadingMode::observedArea;
+		m_IsUsingShadows = true;
+		m_pShadowMap->SetUpdateInterval(1);
+		m_pShadowMap->Invalidate();
+	}
+	else if (m_pShadowMap->GetUpdateInterval() == 1)
+		m_pShadowMap->SetUpdateInterval(4);
+	else if (m_pShadowMap->GetUpdateInterval() == 4)
+		m_pShadowMap->SetUpdateInterval(0);
+	else
+		m_IsUsingShadows = false;
+
+	if (!m_IsUsingShadows)
+		std::cout << "shadows off\n";
+	else if (m_pShadowMap->GetUpdateInterval() == 0)
+		std::cout << "shadows on, static shadow map\n";
+	else
+		std::cout << "shadows on, shadow map every " << m_pShadowMap->GetUpdateInterval() << " frame(s)\n";
+}
+
+void dae::Renderer::CycleShadowMapResolution()
+{
+	const int resolution{ m_pShadowMap->GetResolution() >= 2048 ? 512 : m_pShadowMap->GetResolution() * 2 };
+	m_pShadowMap->SetResolution(resolution);
+	std::cout << "shadow map " << resolution << "x" << resolution << '\n';
+}
+
+void dae::Renderer::CycleDynamicResolution()
+{
+	//off, 16.6 ms, 33.3 ms, back to off
+	if (!m_IsUsingDynamicResolution)
+	{
+		m_IsUsingDynamicResolution = true;
+		m_ResolutionScaler.SetTargetFrameTime(1.f / 60.f);
+		std::cout << "dynamic resolution, 16.6 ms target\n";
+	}
+	else if (m_ResolutionScaler.GetTargetFrameTime() < 1.f / 45.f)
+	{
+		m_ResolutionScaler.SetTargetFrameTime(1.f / 30.f);
+		std::cout << "dynamic resolution, 33.3 ms target\n";
+	}
+	else
+	{
+		m_IsUsingDynamicResolution = false;
+		std::cout << "native resolution\n";
+	}
+}
+
+void dae::Renderer::ToggleMSAA()
+{
+	m_IsUsingMSAA = !m_IsUsingMSAA;
+	std::cout << (m_IsUsingMSAA ? "4x msaa, forward shading only\n" : "msaa off\n");
+}
+
+void dae::Renderer::CycleShadingRate()
+{
+	//full, 2x2, 4x4, automatic, back to full
+	if (m_IsUsingAutomaticShadingRate)
+	{
+		m_IsUsingAutomaticShadingRate = false;
+		m_ShadingRate = ShadingRate::full;
+		std::cout << "shading rate full\n";
+	}
+	else if (m_ShadingRate == ShadingRate::full)
+	{
+		m_ShadingRate = ShadingRate::coarse2x2;
+		std::cout << "shading rate 2x2\n";
+	}
+	else if (m_ShadingRate == ShadingRate::coarse2x2)
+	{
+		m_ShadingRate = ShadingRate::coarse4x4;
+		std::cout << "shading rate 4x4\n";
+	}
+	else
+	{
+		m_IsUsingAutomaticShadingRate = true;
+		std::cout << "shading rate from the screen space velocity\n";
+	}
+}
+
+void dae::Renderer::CycleRenderAhead()
+{
+	//0 -> 1 -> 2 -> back to 0 frames, each one adds a frame of latency
+	m_RenderAhead = (m_RenderAhead + 1) % (maxRenderAhead + 1);
+	std::cout << "render-ahead " << m_RenderAhead << " frame(s)\n";
+}
+
+void dae::Renderer::CycleToneMapping()
+{
+	switch (m_ToneMapping.tonemapOperator)
+	{
+	case ToneMappingOperator::maxToOne:
+		m_ToneMapping.tonemapOperator = ToneMappingOperator::reinhard;
+		std::cout << "tonemapping: reinhard\n";
 		break;
-	case ShadingMode::observedArea:
-		m_ShadingMode = ShadingMode::diffuse;
+	case ToneMappingOperator::reinhard:
+		m_ToneMapping.tonemapOperator = ToneMappingOperator::aces;
+		std::cout << "tonemapping: aces\n";
 		break;
-	case ShadingMode::diffuse:
-		m_ShadingMode = ShadingMode::specular;
+	case ToneMappingOperator::aces:
+		m_ToneMapping.tonemapOperator = ToneMappingOperator::maxToOne;
+		std::cout << "tonemapping: max to one\n";
 		break;
-	case ShadingMode::specular:
-		m_ShadingMode = ShadingMode::combined;
+	}
+}
+
+void dae::Renderer::CycleTextureFilter()
+{
+	switch (m_Sampler.filter)
+	{
+	case TextureFilter::trilinear:
+		m_Sampler.filter = TextureFilter::point;
+		break;
+	case TextureFilter::point:
+		m_Sampler.filter = TextureFilter::bilinear;
+		break;
+	case TextureFilter::bilinear:
+		m_Sampler.filter = TextureFilter::trilinear;
 		break;
 	}
 }
 
+bool Renderer::SelectLOD(MeshInstance& instance) const
+{
+	const MeshGeometry& geometry{ *instance.pGeometry };
+	instance.lodIdx = 0;
+
+	const BoundingBox worldBounds{ geometry.bounds.Transformed(instance.worldMatrix) };
+	const float radius{ worldBounds.GetExtents().Magnitude() };
+	const float distance{ Vector3::Dot(worldBounds.GetCenter() - m_Camera.origin, m_Camera.forward) };
+
+	//camera is inside the bounding sphere
+	if (distance <= radius)
+		return true;
+
+	//pixels covered by one world unit at distance 1, taken from the projection the rasterizer uses
+	const float pixelsPerUnit{ m_Camera.projectionMatrix[1].y * m_Height * 0.5f };
+	if (radius * pixelsPerUnit / distance < m_LODCullSize)
+		return false;
+
+	//lod errors are in object space
+	const float scale{ std::max(instance.worldMatrix.GetAxisX().Magnitude(),
+		std::max(instance.worldMatrix.GetAxisY().Magnitude(), instance.worldMatrix.GetAxisZ().Magnitude())) };
+
+	//measured at the closest point of the sphere so the error is never underestimated
+	const float errorToPixels{ scale * pixelsPerUnit / (distance - radius) };
+	for (int lodIdx{ int(geometry.lods.size()) }; lodIdx > 0; --lodIdx)
+	{
+		if (geometry.lods[lodIdx - 1].error * errorToPixels <= m_LODErrorBudget)
+		{
+			instance.lodIdx = lodIdx;
+			break;
+		}
+	}
+	return true;
+}
+
 float Renderer::Remap(float depth, float min, float max)
 {
-	return { min + depth * max / (max - min) };
+	return dae::Remap(depth, min, max);
 }
 
 void Renderer::VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex>& vertices_out) const
@@ -1529,5 +2005,11 @@ void Renderer::VertexTransformationFunction(std::vector<Mesh>& meshes_in) const
 
 bool Renderer::SaveBufferToImage() const
 {
-	return SDL_SaveBMP(m_pBackBuffer, "Rasterizer_ColorBuffer.bmp");
+	//the image of the last frame is packed at the start of the back buffer, it can be smaller than the window
+	const SDL_PixelFormat* pFormat{ m_pBackBuffer->format };
+	SDL_Surface* pImage{ SDL_CreateRGBSurfaceFrom(m_pBackBuffer->pixels, m_RenderWidth, m_RenderHeight, 32, m_RenderWidth * 4,
+		pFormat->Rmask, pFormat->Gmask, pFormat->Bmask, pFormat->Amask) };
+	const bool hasFailed{ SDL_SaveBMP(pImage, "Rasterizer_ColorBuffer.bmp") != 0 };
+	SDL_FreeSurface(pImage);
+	return hasFailed;
 }
\ No newline at end of file
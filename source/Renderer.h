@@ -1,22 +1,77 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <span>
+#include <tuple>
 #include <vector>
 
 #include "Camera.h"
 #include "DataTypes.h"
+#include "DeferredShading.h"
+#include "GBuffer.h"
+#include "HDRBuffer.h"
+#include "JobSystem.h"
+#include "LightGrid.h"
+#include "Material.h"
+#include "PhongShader.h"
+#include "PixelFormat.h"
+#include "Pipeline.h"
+#include "ResolutionScaler.h"
+#include "Sampler.h"
+#include "ShadowMap.h"
+#include "Texture.h"
 
 struct SDL_Window;
 struct SDL_Surface;
 
 namespace dae
 {
-	class Texture;
+	class AssetCache;
+	class Presenter;
 	struct Mesh;
 	struct Vertex;
 	class Timer;
 	class Scene;
 
+	//everything the raster stage of a frame reads, captured when the frame starts so its vertex stage can run ahead on a worker
+	struct FrameData
+	{
+		//the resolution it is rendered at, the one of the window or lower with dynamic resolution
+		int width{};
+		int height{};
+
+		Camera camera{};
+		LightingConstants lighting{};
+		std::vector<Light> lights{};
+
+		//the visible instances with their lod, the ones that share geometry next to each other
+		std::vector<MeshInstance> renderQueue{};
+		std::vector<ShadingRate> shadingRates{}; //of every entry of the render queue, forward shading only
+
+		//the casters are picked with the rest of the frame, the shadow map itself is drawn by the raster stage
+		bool isDrawingShadowMap{ false };
+		BoundingBox sceneBounds{};
+		std::vector<MeshInstance> shadowCasters{};
+
+		ShadingMode shadingMode{};
+		bool isUsingNormalMap{};
+		bool isShowingTexture{};
+		bool isUsingLocalLights{};
+		bool isUsingShadows{};
+		bool isUsingDeferredShading{};
+		int sampleCount{}; //of the depth buffer and the hdr buffer
+
+		//the output of the vertex stage, one buffer per entry of the render queue, only the layout of this frame is filled
+		template<typename VertexShaderType>
+		using DrawVertices = std::vector<typename Pipeline<VertexShaderType>::ShadedVertices>;
+		std::tuple<
+			DrawVertices<PhongVertexShader<false, false>>, DrawVertices<PhongVertexShader<true, false>>,
+			DrawVertices<PhongVertexShader<false, true>>, DrawVertices<PhongVertexShader<true, true>>> vertices{};
+
+		JobHandle vertexStage{}; //only set while the vertex stage runs as a job of its own
+	};
+
 	class Renderer final
 	{
 	public:
@@ -44,14 +99,17 @@ namespace dae
 		void Render_W3_Part1();
 		void Render_W3_Part2();
 
-		void Render_W4_Part1();
+		void Render_W4_Part1(const FrameData& frame);
+		void Render_W4_Part2(const FrameData& frame);
+
+		//draws the same geometry once per world matrix in the next frame, the vertex data is shared by all of them
+		//the instances join the render queue of the scene, every one of them gets its own buffer of shaded vertices there
+		void DrawInstanced(const GeometryHandle& pGeometry, std::span<const Matrix> worldMatrices, int lodIdx = 0);
 
 		bool FrustumCulling(const Vertex_Out& vertex);
 
 		void ConvertToRasterSpace(Vertex_Out& vertex);
 
-		ColorRGB PixelShading(Vertex_Out* vertex);
-
 		void CycleTexture();
 
 		void ToggleRotation();
@@ -60,6 +118,30 @@ namespace dae
 
 		void CycleShadingMode();
 
+		void CycleLODErrorBudget();
+
+		void CycleTextureFilter();
+
+		void ToggleLocalLights();
+
+		void ToggleDeferredShading();
+
+		void CycleShadows();
+
+		void CycleShadowMapResolution();
+
+		void CycleToneMapping();
+
+		void CycleRenderAhead();
+
+		void CycleDynamicResolution();
+
+		void CycleShadingRate();
+
+		void ToggleMSAA();
+
+		void PrintAssetMemory() const;
+
 		float Remap(float depth, float min = 0.985f, float max = 1.f);
 
 		bool SaveBufferToImage() const;
@@ -67,37 +149,201 @@ namespace dae
 	private:
 		SDL_Window* m_pWindow{};
 
-		SDL_Surface* m_pFrontBuffer{ nullptr };
+		//every thread of the renderer but the present thread, a worker per hardware thread besides the main thread
+		JobSystem* m_pJobs{};
+
+		//owns the back buffers, m_pBackBuffer is the one of the current frame
+		Presenter* m_pPresenter{};
 		SDL_Surface* m_pBackBuffer{ nullptr };
 		uint32_t* m_pBackBufferPixels{};
 
+		//window sized with room for every sample, a frame at a lower resolution or with one sample only uses the start of it
 		float* m_pDepthBufferPixels{};
 
+		//the W4 paths shade into the hdr buffer, it is tonemapped and packed into the back buffer with this layout once per frame
+		HDRBuffer* m_pHDRBuffer{};
+		PixelFormat m_PixelFormat{};
+		ToneMapping m_ToneMapping{};
+		ColorRGB m_ClearColor{ 100.5f / 255.f, 100.5f / 255.f, 100.5f / 255.f }; //the gray of the back buffer, half a step up so it truncates to 100
+
 		Camera m_Camera{};
 
 		int m_Width{};
 		int m_Height{};
 
-		Texture* m_pTexture{};
-		Texture* m_pNormal{};
-		Texture* m_pDiffuse{};
-		Texture* m_pGloss{};
-		Texture* m_pSpecular{};
+		//the render resolution follows the render time, the present thread scales the image up to m_Width x m_Height
+		bool m_IsUsingDynamicResolution{ false };
+		ResolutionScaler m_ResolutionScaler{ 1.f / 60.f, 0.5f, 1.f };
+		int m_RenderWidth{}; //of the image in m_pBackBuffer
+		int m_RenderHeight{};
+
+		TextureHandle m_pTexture{};
+		GeometryHandle m_pTuktukMesh{};
+		Material* m_pMaterial{};
+		//blockCompressed takes a third of the memory, but with a single material the decode costs more than the bandwidth it saves
+		MaterialFormat m_MaterialFormat{ MaterialFormat::packed };
 
 		bool m_IsShowingTexture{ true };
 		bool m_IsRotating{ false };
 		bool m_IsUsingNormalMap{ false };
 
-		enum class ShadingMode
+		ShadingMode m_ShadingMode{ ShadingMode::combined };
+
+		//coarse shading runs the pixel shader once per 2x2 or 4x4 pixels, automatic picks the rate of every draw from how fast it moves on screen
+		ShadingRate m_ShadingRate{ ShadingRate::full };
+		bool m_IsUsingAutomaticShadingRate{ false };
+		static constexpr float coarseVelocity{ 4.f }; //pixels per frame from which 2x2 is used
+		static constexpr float coarsestVelocity{ 16.f }; //and 4x4
+
+		//where every object of the scene was on screen, only compared with the frame right after it
+		struct ScreenTransform
 		{
-			observedArea, diffuse, specular, combined
+			Matrix worldViewProjection{};
+			uint64_t frame{};
 		};
+		std::vector<ScreenTransform> m_PreviousScreenTransforms{};
 
-		ShadingMode m_ShadingMode{ ShadingMode::combined };
+		LightingConstants m_Lighting{};
 
 		float m_RotationAngle{};
 
-		std::vector<Mesh> m_Meshes;
+		SamplerState m_Sampler{};
+
+		AssetCache* m_pAssets{};
+		Scene* m_pScene{};
+		size_t m_VehicleId{ SIZE_MAX }; //SIZE_MAX when the vehicle mesh failed to load
+
+		//frame n is captured into m_Frames[n % 3], its vertex stage starts right away and it is rasterized m_RenderAhead frames later
+		//0 rasterizes every frame in the Render() call that starts it, more overlaps the vertex stage with the raster stage of older frames
+		static constexpr int maxRenderAhead{ 2 };
+		int m_RenderAhead{ 0 };
+		std::array<FrameData, maxRenderAhead + 1> m_Frames{};
+		uint64_t m_StartedFrames{};
+		uint64_t m_RasterizedFrames{};
+
+		//point and spot lights, culled per screen tile after a depth prepass
+		bool m_IsUsingLocalLights{ false };
+		std::vector<Light> m_LightRig{}; //around the vehicle, before the rig is moved
+		std::vector<Light> m_Lights{};
+		float m_LightAngle{};
+		LightGrid m_LightGrid{};
+
+		//the directional light casts shadows through a shadow map, it is redrawn every m_pShadowMap->GetUpdateInterval() frames
+		bool m_IsUsingShadows{ false };
+		ShadowMap* m_pShadowMap{};
+
+		//coverage and depth per sample, the pixel shader still runs once per pixel, the g-buffer of deferred shading has a single sample
+		bool m_IsUsingMSAA{ false };
+
+		//deferred shading draws every mesh into the g-buffer first and lights each pixel once afterwards
+		bool m_IsUsingDeferredShading{ false };
+		GBuffer* m_pGBuffer{};
+
+		//instances handed to DrawInstanced since the last frame was captured
+		std::vector<MeshInstance> m_InstancedDraws{};
+
+		float m_LODErrorBudget{ 1.f }; //max screen space error in pixels
+		float m_LODCullSize{ 1.f }; //meshes with a smaller projected radius in pixels are skipped
+
+		//picks the coarsest lod within the error budget, false if the mesh is too small to draw at all
+		bool SelectLOD(MeshInstance& instance) const;
+
+		void UpdateLightingConstants();
+
+		//captures the camera, lights, render queue and state of a new frame and starts its vertex stage
+		void BeginFrame();
+
+		//draws the shadow map when the frame picked it, before anything reads it
+		void UpdateShadowMap(const FrameData& frame);
+
+		//the visible instances with their lod, the ones that share geometry next to each other
+		void BuildRenderQueue(std::vector<MeshInstance>& renderQueue);
+
+		//the shading rate of every entry of the render queue
+		void SelectShadingRates(FrameData& frame);
+		void DrawRenderQueue(const FrameData& frame);
+
+		//the vertex stage, every entry of the render queue through the vertex shader with the layout of the frame
+		//only reads the frame and the geometry it holds on to, it can run next to the raster stage of another frame
+		template<bool isUsingNormalMap, bool isUsingWorldPosition>
+		void ShadeVertices(FrameData& frame) const;
+
+		using VertexStageFunction = void (Renderer::*)(FrameData&) const;
+		VertexStageFunction SelectVertexStageFunction(const FrameData& frame) const;
+
+		//depth prepass, local lights always pass the world position on
+		template<bool isUsingNormalMap>
+		void DrawDepth(const FrameData& frame, size_t drawIdx);
+
+		void CreateLocalLights(int count);
+		void UpdateLocalLights(float deltaTime);
+
+		//the phong shaders are compiled once per combination of shading mode, normal map, texture, local lights and shadows
+		//the raster stage of one entry of the render queue
+		template<ShadingMode shadingMode, bool isUsingNormalMap, bool isShowingTexture, bool isUsingLocalLights, bool isUsingShadows>
+		void DrawPhong(const FrameData& frame, size_t drawIdx);
+
+		using DrawFunction = void (Renderer::*)(const FrameData&, size_t);
+		using LightDrawVariants = std::array<std::array<DrawFunction, 2>, 2>; //local lights, shadows
+		using DrawVariants = std::array<std::array<LightDrawVariants, 2>, 2>; //normal map, texture
+
+		template<ShadingMode shadingMode, bool isUsingNormalMap, bool isShowingTexture>
+		static constexpr LightDrawVariants GetLightDrawVariants()
+		{
+			return { {
+				{ &Renderer::DrawPhong<shadingMode, isUsingNormalMap, isShowingTexture, false, false>, &Renderer::DrawPhong<shadingMode, isUsingNormalMap, isShowingTexture, false, true> },
+				{ &Renderer::DrawPhong<shadingMode, isUsingNormalMap, isShowingTexture, true, false>, &Renderer::DrawPhong<shadingMode, isUsingNormalMap, isShowingTexture, true, true> }
+			} };
+		}
+
+		template<ShadingMode shadingMode>
+		static constexpr DrawVariants GetDrawVariants()
+		{
+			return { {
+				{ GetLightDrawVariants<shadingMode, false, false>(), GetLightDrawVariants<shadingMode, false, true>() },
+				{ GetLightDrawVariants<shadingMode, true, false>(), GetLightDrawVariants<shadingMode, true, true>() }
+			} };
+		}
+
+		//the geometry pass of deferred shading, the shading mode and local lights only matter to the lighting pass
+		template<bool isUsingNormalMap, bool isShowingTexture>
+		void DrawGBuffer(const FrameData& frame, size_t drawIdx);
+
+		static constexpr std::array<std::array<DrawFunction, 2>, 2> GetGBufferDrawVariants() //normal map, texture
+		{
+			return { {
+				{ &Renderer::DrawGBuffer<false, false>, &Renderer::DrawGBuffer<false, true> },
+				{ &Renderer::DrawGBuffer<true, false>, &Renderer::DrawGBuffer<true, true> }
+			} };
+		}
+
+		//the variant for the state of the frame
+		DrawFunction SelectDrawFunction(const FrameData& frame) const;
+
+		template<ShadingMode shadingMode, bool isShowingTexture, bool isUsingLocalLights, bool isUsingShadows>
+		void ShadeGBuffer(const FrameData& frame);
+
+		using ShadeFunction = void (Renderer::*)(const FrameData&);
+		using LightShadeVariants = std::array<std::array<ShadeFunction, 2>, 2>; //local lights, shadows
+		using ShadeVariants = std::array<LightShadeVariants, 2>; //texture
+
+		template<ShadingMode shadingMode, bool isShowingTexture>
+		static constexpr LightShadeVariants GetLightShadeVariants()
+		{
+			return { {
+				{ &Renderer::ShadeGBuffer<shadingMode, isShowingTexture, false, false>, &Renderer::ShadeGBuffer<shadingMode, isShowingTexture, false, true> },
+				{ &Renderer::ShadeGBuffer<shadingMode, isShowingTexture, true, false>, &Renderer::ShadeGBuffer<shadingMode, isShowingTexture, true, true> }
+			} };
+		}
+
+		template<ShadingMode shadingMode>
+		static constexpr ShadeVariants GetShadeVariants()
+		{
+			return { GetLightShadeVariants<shadingMode, false>(), GetLightShadeVariants<shadingMode, true>() };
+		}
+
+		//the lighting pass for the state of the frame
+		ShadeFunction SelectShadeFunction(const FrameData& frame) const;
 
 		//Function that transforms the vertices from the mesh from World space to Screen space
 		void VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex>& vertices_out) const; 
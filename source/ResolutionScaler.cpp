@@ -0,0 +1,61 @@
+#include "ResolutionScaler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace dae
+{
+	ResolutionScaler::ResolutionScaler(float targetFrameTime, float minScale, float maxScale) :
+		m_TargetFrameTime{ targetFrameTime }
+	{
+		SetBounds(minScale, maxScale);
+		m_Scale = m_MaxScale;
+	}
+
+	void ResolutionScaler::SetTargetFrameTime(float targetFrameTime)
+	{
+		m_TargetFrameTime = targetFrameTime;
+		m_FrameCount = 0;
+	}
+
+	void ResolutionScaler::SetBounds(float minScale, float maxScale)
+	{
+		m_MinScale = std::clamp(minScale, scaleStep, 1.f);
+		m_MaxScale = std::clamp(maxScale, m_MinScale, 1.f);
+		m_Scale = std::clamp(m_Scale, m_MinScale, m_MaxScale);
+		m_FrameCount = 0;
+	}
+
+	void ResolutionScaler::AddFrameTime(float frameTime)
+	{
+		m_FrameTimes[m_FrameCount % windowSize] = frameTime;
+		if (++m_FrameCount < windowSize)
+			return;
+
+		//a frame within the target and the margin keeps the scale, that leaves room for noise without going back and forth
+		const float averageFrameTime{ std::accumulate(m_FrameTimes.begin(), m_FrameTimes.end(), 0.f) / windowSize };
+		if (averageFrameTime <= m_TargetFrameTime && averageFrameTime >= m_TargetFrameTime * upscaleMargin)
+			return;
+
+		//the pixel count goes with the square of the scale, at most a quarter less or a third more per change
+		const float ratio{ std::clamp(m_TargetFrameTime / averageFrameTime, 0.56f, 1.78f) };
+
+		//whole steps, rounded down but always at least one in the direction of the target
+		const int currentStep{ int(lroundf(m_Scale / scaleStep)) };
+		int step{ int(floorf(m_Scale * sqrtf(ratio) / scaleStep)) };
+		step = ratio < 1.f ? std::min(step, currentStep - 1) : std::max(step, currentStep + 1);
+
+		const float scale{ std::clamp(step * scaleStep, m_MinScale, m_MaxScale) };
+		if (scale == m_Scale)
+			return;
+
+		m_Scale = scale;
+		m_FrameCount = 0;
+	}
+
+	void ResolutionScaler::GetRenderSize(int outputWidth, int outputHeight, int& width, int& height) const
+	{
+		width = std::max(1, int(outputWidth * m_Scale + 0.5f));
+		height = std::max(1, int(outputHeight * m_Scale + 0.5f));
+	}
+}
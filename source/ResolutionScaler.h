@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+
+namespace dae
+{
+	//picks the fraction of the output resolution to render at, so the render time stays at a target
+	//the cost is taken to follow the pixel count, a scale only changes once a full window of frames was rendered at the current one
+	class ResolutionScaler final
+	{
+	public:
+		ResolutionScaler(float targetFrameTime, float minScale, float maxScale);
+		~ResolutionScaler() = default;
+
+		ResolutionScaler(const ResolutionScaler&) = delete;
+		ResolutionScaler(ResolutionScaler&&) noexcept = delete;
+		ResolutionScaler& operator=(const ResolutionScaler&) = delete;
+		ResolutionScaler& operator=(ResolutionScaler&&) noexcept = delete;
+
+		//seconds
+		void SetTargetFrameTime(float targetFrameTime);
+		float GetTargetFrameTime() const { return m_TargetFrameTime; }
+
+		//fractions of the output width and height, the scale is kept inside them
+		void SetBounds(float minScale, float maxScale);
+
+		//the render time of the frame that was just drawn at GetScale(), in seconds
+		void AddFrameTime(float frameTime);
+
+		float GetScale() const { return m_Scale; }
+
+		//the size to render at for an output of outputWidth x outputHeight, never 0
+		void GetRenderSize(int outputWidth, int outputHeight, int& width, int& height) const;
+
+	private:
+		static constexpr int windowSize{ 8 }; //frames averaged before the scale is changed again
+		static constexpr float scaleStep{ 0.05f }; //of the output, fewer distinct sizes means fewer reallocations and less popping
+		static constexpr float upscaleMargin{ 0.85f }; //only scale up when a frame takes less than this part of the target
+
+		float m_TargetFrameTime{};
+		float m_MinScale{};
+		float m_MaxScale{};
+		float m_Scale{};
+
+		std::array<float, windowSize> m_FrameTimes{};
+		int m_FrameCount{}; //rendered at the current scale
+	};
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <emmintrin.h>
+
+#include "Vector2.h"
+
+namespace dae
+{
+	enum class TextureFilter
+	{
+		point,    //nearest texel of the top level
+		bilinear, //4 texels of the top level
+		trilinear //bilinear on the two mip levels closest to the pixel footprint
+	};
+
+	enum class TextureAddressMode
+	{
+		wrap,
+		clamp
+	};
+
+	struct SamplerState
+	{
+		TextureFilter filter{ TextureFilter::trilinear };
+		TextureAddressMode addressMode{ TextureAddressMode::wrap };
+	};
+
+	//addressing and filtering shared by everything that stores texels, scalar and 4 lanes wide
+	namespace Sampling
+	{
+		inline int AddressCoordinate(int coordinate, int size, TextureAddressMode addressMode)
+		{
+			if (addressMode == TextureAddressMode::clamp)
+				return std::clamp(coordinate, 0, size - 1);
+
+			const int wrapped{ coordinate % size };
+			return wrapped < 0 ? wrapped + size : wrapped;
+		}
+
+		//SSE2 has no floor, truncate and step down where that rounded up
+		inline __m128 Floor(__m128 x)
+		{
+			const __m128 truncated{ _mm_cvtepi32_ps(_mm_cvttps_epi32(x)) };
+			return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.f)));
+		}
+
+		//coordinates are whole numbers stored as floats
+		inline __m128 AddressCoordinates(__m128 coordinates, int size, TextureAddressMode addressMode)
+		{
+			const __m128 sizeV{ _mm_set1_ps(float(size)) };
+			if (addressMode == TextureAddressMode::clamp)
+				return _mm_max_ps(_mm_setzero_ps(), _mm_min_ps(_mm_sub_ps(sizeV, _mm_set1_ps(1.f)), coordinates));
+
+			return _mm_sub_ps(coordinates, _mm_mul_ps(sizeV, Floor(_mm_div_ps(coordinates, sizeV))));
+		}
+
+		//the 4 texels and weights around uv * size of every lane, texel centers sit at half texel offsets
+		struct BilinearFootprint
+		{
+			alignas(16) int x0[4]{};
+			alignas(16) int y0[4]{};
+			alignas(16) int x1[4]{};
+			alignas(16) int y1[4]{};
+			__m128 weights[4]{}; //x0y0, x1y0, x0y1, x1y1
+		};
+
+		inline BilinearFootprint GetBilinearFootprint(__m128 u, __m128 v, int width, int height, TextureAddressMode addressMode)
+		{
+			const __m128 half{ _mm_set1_ps(0.5f) };
+			const __m128 one{ _mm_set1_ps(1.f) };
+
+			const __m128 x{ _mm_sub_ps(_mm_mul_ps(u, _mm_set1_ps(float(width))), half) };
+			const __m128 y{ _mm_sub_ps(_mm_mul_ps(v, _mm_set1_ps(float(height))), half) };
+			const __m128 xFloor{ Floor(x) };
+			const __m128 yFloor{ Floor(y) };
+			const __m128 fx{ _mm_sub_ps(x, xFloor) };
+			const __m128 fy{ _mm_sub_ps(y, yFloor) };
+
+			BilinearFootprint footprint{};
+			_mm_store_si128(reinterpret_cast<__m128i*>(footprint.x0), _mm_cvttps_epi32(AddressCoordinates(xFloor, width, addressMode)));
+			_mm_store_si128(reinterpret_cast<__m128i*>(footprint.y0), _mm_cvttps_epi32(AddressCoordinates(yFloor, height, addressMode)));
+			_mm_store_si128(reinterpret_cast<__m128i*>(footprint.x1), _mm_cvttps_epi32(AddressCoordinates(_mm_add_ps(xFloor, one), width, addressMode)));
+			_mm_store_si128(reinterpret_cast<__m128i*>(footprint.y1), _mm_cvttps_epi32(AddressCoordinates(_mm_add_ps(yFloor, one), height, addressMode)));
+
+			const __m128 invFx{ _mm_sub_ps(one, fx) };
+			const __m128 invFy{ _mm_sub_ps(one, fy) };
+			footprint.weights[0] = _mm_mul_ps(invFx, invFy);
+			footprint.weights[1] = _mm_mul_ps(fx, invFy);
+			footprint.weights[2] = _mm_mul_ps(invFx, fy);
+			footprint.weights[3] = _mm_mul_ps(fx, fy);
+			return footprint;
+		}
+
+		//one byte of 4 packed texels -> [0, 1]
+		inline __m128 UnpackChannel(__m128i texels, int shift)
+		{
+			const __m128i channel{ _mm_and_si128(_mm_srl_epi32(texels, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(0xFF)) };
+			return _mm_mul_ps(_mm_cvtepi32_ps(channel), _mm_set1_ps(1.f / 255.f));
+		}
+
+		//the mip level for a pixel footprint, in levels of a width x height top level
+		inline float GetMipLevel(const Vector2& uvDdx, const Vector2& uvDdy, int width, int height, int mipCount)
+		{
+			const Vector2 ddx{ uvDdx.x * width, uvDdx.y * height };
+			const Vector2 ddy{ uvDdy.x * width, uvDdy.y * height };
+			const float footprint{ std::max(ddx.SqrMagnitude(), ddy.SqrMagnitude()) };
+
+			//log2 of the length, taken on the squared length to skip the sqrt
+			const float lod{ 0.5f * std::log2(std::max(footprint, 1e-8f)) };
+			return std::clamp(lod, 0.f, float(mipCount - 1));
+		}
+
+		//average of 4 texels, per byte with rounding
+		inline uint32_t Average(uint32_t t0, uint32_t t1, uint32_t t2, uint32_t t3)
+		{
+			uint32_t result{};
+			for (int shift{ 0 }; shift < 32; shift += 8)
+			{
+				const uint32_t sum{ ((t0 >> shift) & 0xFF) + ((t1 >> shift) & 0xFF) + ((t2 >> shift) & 0xFF) + ((t3 >> shift) & 0xFF) };
+				result |= ((sum + 2) / 4) << shift;
+			}
+			return result;
+		}
+	}
+}
@@ -0,0 +1,189 @@
+#include "Scene.h"
+#include <cassert>
+
+namespace dae
+{
+	size_t Scene::AddInstance(const GeometryHandle& pGeometry, const Matrix& worldMatrix)
+	{
+		assert(pGeometry);
+
+		SceneObject object{ MeshInstance{ pGeometry, worldMatrix } };
+		object.instance.objectId = m_Objects.size();
+		object.worldBounds = pGeometry->bounds.Transformed(worldMatrix);
+		m_Objects.push_back(object);
+
+		m_IsHierarchyDirty = true;
+		return m_Objects.size() - 1;
+	}
+
+	void Scene::SetWorldMatrix(size_t objectId, const Matrix& worldMatrix)
+	{
+		assert(objectId < m_Objects.size());
+
+		SceneObject& object{ m_Objects[objectId] };
+		object.instance.worldMatrix = worldMatrix;
+		object.worldBounds = object.instance.pGeometry->bounds.Transformed(worldMatrix);
+
+		if (!m_IsHierarchyDirty)
+		{
+			m_Nodes[m_LeafOfObject[objectId]].bounds = object.worldBounds;
+			m_AreBoundsDirty = true;
+		}
+	}
+
+	MeshInstance& Scene::GetInstance(size_t objectId)
+	{
+		assert(objectId < m_Objects.size());
+		return m_Objects[objectId].instance;
+	}
+
+	BoundingBox Scene::GetBounds()
+	{
+		if (m_IsHierarchyDirty)
+			Build();
+		else if (m_AreBoundsDirty)
+			Refit();
+
+		return m_Nodes.empty() ? BoundingBox{} : m_Nodes[0].bounds;
+	}
+
+	const std::vector<MeshInstance*>& Scene::GetVisibleInstances(const Frustum& frustum)
+	{
+		if (m_IsHierarchyDirty)
+			Build();
+		else if (m_AreBoundsDirty)
+			Refit();
+
+		m_VisibleInstances.clear();
+		if (m_Nodes.empty())
+			return m_VisibleInstances;
+
+		int stack[64]{};
+		int stackSize{ 0 };
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const int nodeIdx{ stack[--stackSize] };
+			const BVHNode& node{ m_Nodes[nodeIdx] };
+
+			const Containment containment{ frustum.Test(node.bounds) };
+			if (containment == Containment::outside)
+				continue;
+
+			//fully inside -> no need to test anything below this node
+			if (containment == Containment::inside)
+			{
+				CollectSubtree(nodeIdx);
+				continue;
+			}
+
+			if (node.firstChild < 0)
+			{
+				m_VisibleInstances.push_back(&m_Objects[node.objectId].instance);
+				continue;
+			}
+
+			assert(stackSize + 2 <= 64);
+			stack[stackSize++] = node.secondChild;
+			stack[stackSize++] = node.firstChild;
+		}
+
+		return m_VisibleInstances;
+	}
+
+	void Scene::Build()
+	{
+		m_Nodes.clear();
+		m_LeafOfObject.assign(m_Objects.size(), -1);
+
+		if (!m_Objects.empty())
+		{
+			std::vector<int> objectIds(m_Objects.size());
+			for (int i{ 0 }; i < int(objectIds.size()); ++i)
+				objectIds[i] = i;
+
+			m_Nodes.reserve(2 * m_Objects.size() - 1);
+			BuildRecursive(objectIds, 0, int(objectIds.size()));
+		}
+
+		m_IsHierarchyDirty = false;
+		m_AreBoundsDirty = false;
+	}
+
+	int Scene::BuildRecursive(std::vector<int>& objectIds, int begin, int end)
+	{
+		const int nodeIdx{ int(m_Nodes.size()) };
+		m_Nodes.emplace_back();
+
+		if (end - begin == 1)
+		{
+			const int objectId{ objectIds[begin] };
+			m_Nodes[nodeIdx].bounds = m_Objects[objectId].worldBounds;
+			m_Nodes[nodeIdx].objectId = objectId;
+			m_LeafOfObject[objectId] = nodeIdx;
+			return nodeIdx;
+		}
+
+		//split at the median of the object centers along the widest axis
+		BoundingBox bounds{};
+		BoundingBox centerBounds{};
+		for (int i{ begin }; i < end; ++i)
+		{
+			bounds.Grow(m_Objects[objectIds[i]].worldBounds);
+			centerBounds.Grow(m_Objects[objectIds[i]].worldBounds.GetCenter());
+		}
+
+		const Vector3 size{ centerBounds.max - centerBounds.min };
+		int axis{ 0 };
+		if (size.y > size[axis])
+			axis = 1;
+		if (size.z > size[axis])
+			axis = 2;
+
+		const int middle{ begin + (end - begin) / 2 };
+		std::nth_element(objectIds.begin() + begin, objectIds.begin() + middle, objectIds.begin() + end,
+			[this, axis](int a, int b)
+			{
+				return m_Objects[a].worldBounds.GetCenter()[axis] < m_Objects[b].worldBounds.GetCenter()[axis];
+			});
+
+		//children are always stored after their parent, Refit relies on that
+		const int firstChild{ BuildRecursive(objectIds, begin, middle) };
+		const int secondChild{ BuildRecursive(objectIds, middle, end) };
+
+		m_Nodes[nodeIdx].bounds = bounds;
+		m_Nodes[nodeIdx].firstChild = firstChild;
+		m_Nodes[nodeIdx].secondChild = secondChild;
+		return nodeIdx;
+	}
+
+	void Scene::Refit()
+	{
+		//leaves are already up to date, walk back to front so children are done before their parent
+		for (int i{ int(m_Nodes.size()) - 1 }; i >= 0; --i)
+		{
+			BVHNode& node{ m_Nodes[i] };
+			if (node.firstChild < 0)
+				continue;
+
+			node.bounds = m_Nodes[node.firstChild].bounds;
+			node.bounds.Grow(m_Nodes[node.secondChild].bounds);
+		}
+
+		m_AreBoundsDirty = false;
+	}
+
+	void Scene::CollectSubtree(int nodeIdx)
+	{
+		const BVHNode& node{ m_Nodes[nodeIdx] };
+		if (node.firstChild < 0)
+		{
+			m_VisibleInstances.push_back(&m_Objects[node.objectId].instance);
+			return;
+		}
+
+		CollectSubtree(node.firstChild);
+		CollectSubtree(node.secondChild);
+	}
+}
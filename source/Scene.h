@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+
+#include "Bounds.h"
+#include "DataTypes.h"
+
+namespace dae
+{
+	class Scene final
+	{
+	public:
+		Scene() = default;
+		~Scene() = default;
+
+		Scene(const Scene&) = delete;
+		Scene(Scene&&) noexcept = delete;
+		Scene& operator=(const Scene&) = delete;
+		Scene& operator=(Scene&&) noexcept = delete;
+
+		//returns the id of the object, used to update it later on
+		size_t AddInstance(const GeometryHandle& pGeometry, const Matrix& worldMatrix);
+
+		void SetWorldMatrix(size_t objectId, const Matrix& worldMatrix);
+
+		MeshInstance& GetInstance(size_t objectId);
+		size_t GetObjectCount() const { return m_Objects.size(); }
+
+		//the world bounds of every instance together
+		BoundingBox GetBounds();
+
+		//only the instances whose world bounds touch the frustum, valid until the next call
+		const std::vector<MeshInstance*>& GetVisibleInstances(const Frustum& frustum);
+
+	private:
+		struct SceneObject
+		{
+			MeshInstance instance{};
+			BoundingBox worldBounds{};
+		};
+
+		struct BVHNode
+		{
+			BoundingBox bounds{};
+			//inner node -> children, leaf -> firstChild is -1 and objectId is set
+			int firstChild{ -1 };
+			int secondChild{ -1 };
+			int objectId{ -1 };
+		};
+
+		std::vector<SceneObject> m_Objects{};
+		std::vector<BVHNode> m_Nodes{};
+		std::vector<int> m_LeafOfObject{};
+		std::vector<MeshInstance*> m_VisibleInstances{};
+
+		bool m_IsHierarchyDirty{ false };
+		bool m_AreBoundsDirty{ false };
+
+		void Build();
+		int BuildRecursive(std::vector<int>& objectIds, int begin, int end);
+		void Refit();
+		void CollectSubtree(int nodeIdx);
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+
+#include "ColorRGB.h"
+#include "DataTypes.h"
+
+namespace dae
+{
+	//a vertex shader declares the varyings it hands to the pixel shader and returns the clip space position
+	//
+	//	struct UVVertexShader
+	//	{
+	//		struct Varyings { Vector2 uv{}; };
+	//		Vector4 Shade(const Vertex& vertex, Varyings& varyings) const;
+	//	};
+	//
+	//the pixel shader gets the varyings of a 2x2 quad at a time, so it can take derivatives across it
+	//
+	//	struct UVPixelShader
+	//	{
+	//		void ShadeQuad(const PixelQuad<UVVertexShader::Varyings>& quad, ColorRGB (&colors)[4]) const;
+	//	};
+	//
+	//or it writes its own targets (a g-buffer), the pipeline then only keeps the depth buffer
+	//
+	//	struct UVSurfaceShader
+	//	{
+	//		void ShadeQuad(const PixelQuad<UVVertexShader::Varyings>& quad) const;
+	//	};
+	//
+	//both are template parameters of the Pipeline, so the calls inline into its loops
+
+	//varyings are nothing but floats (Vector2, Vector3, ColorRGB, ...), they are interpolated as one flat array
+	template<typename Varyings>
+	concept VaryingLayout = std::is_trivially_copyable_v<Varyings> && std::is_default_constructible_v<Varyings> &&
+		sizeof(Varyings) % sizeof(float) == 0 && alignof(Varyings) == alignof(float);
+
+	template<VaryingLayout Varyings>
+	struct PixelQuad
+	{
+		Varyings varyings[4]{}; //lane x + 2 * y, lanes outside the triangle are extrapolated
+		int x{}; //pixel of lane 0, x and y are even, with coarse shading the top left pixel of the block of lane 0
+		int y{};
+		float depths[4]{};
+		bool isVisible[4]{}; //covered and in front, only these lanes are written
+	};
+
+	template<typename Shader>
+	concept VertexShader = VaryingLayout<typename Shader::Varyings> &&
+		requires(const Shader& shader, const Vertex& vertex, typename Shader::Varyings& varyings)
+	{
+		{ shader.Shade(vertex, varyings) } -> std::same_as<Vector4>;
+	};
+
+	template<typename Shader, typename Varyings>
+	concept ColorPixelShader = requires(const Shader& shader, const PixelQuad<Varyings>& quad, ColorRGB (&colors)[4])
+	{
+		shader.ShadeQuad(quad, colors);
+	};
+
+	template<typename Shader, typename Varyings>
+	concept SurfacePixelShader = requires(const Shader& shader, const PixelQuad<Varyings>& quad)
+	{
+		shader.ShadeQuad(quad);
+	};
+
+	template<typename Shader, typename Varyings>
+	concept PixelShader = ColorPixelShader<Shader, Varyings> || SurfacePixelShader<Shader, Varyings>;
+
+	namespace Varying
+	{
+		template<VaryingLayout Varyings>
+		using Floats = std::array<float, sizeof(Varyings) / sizeof(float)>;
+
+		template<VaryingLayout Varyings>
+		Varyings Divide(const Varyings& varyings, float w)
+		{
+			Floats<Varyings> floats{ std::bit_cast<Floats<Varyings>>(varyings) };
+			for (float& value : floats)
+				value /= w;
+			return std::bit_cast<Varyings>(floats);
+		}
+
+		//perspective correct, the vertices hold their varyings divided by w and w is the interpolated one
+		template<VaryingLayout Varyings>
+		Varyings Interpolate(const Varyings& v1, const Varyings& v2, const Varyings& v3, float w1, float w2, float w3, float w)
+		{
+			const Floats<Varyings> floats1{ std::bit_cast<Floats<Varyings>>(v1) };
+			const Floats<Varyings> floats2{ std::bit_cast<Floats<Varyings>>(v2) };
+			const Floats<Varyings> floats3{ std::bit_cast<Floats<Varyings>>(v3) };
+
+			Floats<Varyings> result{};
+			for (size_t i{ 0 }; i < result.size(); ++i)
+				result[i] = (floats1[i] * w1 + floats2[i] * w2 + floats3[i] * w3) * w;
+			return std::bit_cast<Varyings>(result);
+		}
+	}
+}
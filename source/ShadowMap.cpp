@@ -0,0 +1,151 @@
+#include "ShadowMap.h"
+#include <emmintrin.h>
+
+namespace dae
+{
+	ShadowMap::ShadowMap(int resolution)
+	{
+		SetResolution(resolution);
+	}
+
+	void ShadowMap::SetResolution(int resolution)
+	{
+		m_Resolution = (std::max(resolution, 4) + 3) & ~3;
+		m_Depth.assign(size_t(m_Resolution) * m_Resolution, 1.f);
+		m_IsValid = false;
+	}
+
+	bool ShadowMap::NextFrame()
+	{
+		++m_FramesSinceUpdate;
+		const bool isDue{ !m_IsValid || (m_UpdateInterval > 0 && m_FramesSinceUpdate >= m_UpdateInterval) };
+		if (isDue)
+			m_FramesSinceUpdate = 0;
+		return isDue;
+	}
+
+	void ShadowMap::Begin(const Vector3& lightDirection, const BoundingBox& sceneBounds)
+	{
+		std::fill(m_Depth.begin(), m_Depth.end(), 1.f);
+		m_IsValid = true;
+		if (!sceneBounds.IsValid())
+			return;
+
+		float texelSize{};
+		m_LightViewProjection = FitLightVolume(lightDirection, sceneBounds, texelSize);
+		m_NormalOffset = 1.5f * texelSize;
+	}
+
+	Matrix ShadowMap::FitLightVolume(const Vector3& lightDirection, const BoundingBox& sceneBounds, float& texelSize) const
+	{
+		//a sphere around the bounds holds them however they turn, its radius is rounded up so the texel size only changes in steps
+		const float radius{ std::max(1.f, ceilf(sceneBounds.GetExtents().Magnitude())) };
+		texelSize = 2.f * radius / m_Resolution;
+
+		const Vector3 up{ fabsf(lightDirection.y) > 0.99f ? Vector3::UnitZ : Vector3::UnitY };
+		const Matrix lightRotation{ Matrix::CreateLookAtLH(Vector3::Zero, lightDirection, up) };
+
+		//the center snapped to whole texels, moving casters then do not make the shadow edges crawl
+		Vector3 center{ lightRotation.TransformPoint(sceneBounds.GetCenter()) };
+		center.x = roundf(center.x / texelSize) * texelSize;
+		center.y = roundf(center.y / texelSize) * texelSize;
+
+		const Matrix lightView{ lightRotation * Matrix::CreateTranslation(-center.x, -center.y, radius - center.z) };
+		return lightView * Matrix::CreateOrthographicLH(2.f * radius, 2.f * radius, 0.f, 2.f * radius);
+	}
+
+	void ShadowMap::DrawCaster(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const Matrix& worldMatrix)
+	{
+		//orthographic, w stays 1 and the depth is linear across the triangle
+		const Matrix worldViewProjection{ worldMatrix * m_LightViewProjection };
+		const float halfResolution{ 0.5f * m_Resolution };
+
+		m_Positions.resize(vertices.size());
+		for (size_t i{ 0 }; i < vertices.size(); ++i)
+		{
+			const Vector3 position{ worldViewProjection.TransformPoint(vertices[i].position) };
+			m_Positions[i] = { (position.x + 1.f) * halfResolution, (1.f - position.y) * halfResolution, position.z };
+		}
+
+		const __m128 laneOffsets{ _mm_setr_ps(0.f, 1.f, 2.f, 3.f) };
+		const __m128 zero{ _mm_setzero_ps() };
+
+		for (size_t i{ 0 }; i + 2 < indices.size(); i += 3)
+		{
+			const Vector3& v0{ m_Positions[indices[i]] };
+			Vector3 v1{ m_Positions[indices[i + 1]] };
+			Vector3 v2{ m_Positions[indices[i + 2]] };
+
+			//both windings cast a shadow, the back facing ones are turned around
+			float area{ (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x) };
+			if (area == 0.f)
+				continue;
+			if (area < 0.f)
+			{
+				std::swap(v1, v2);
+				area = -area;
+			}
+
+			//pixel centers are at + 0.5
+			const int minX{ std::max(0, int(ceilf(std::min(v0.x, std::min(v1.x, v2.x)) - 0.5f))) };
+			const int minY{ std::max(0, int(ceilf(std::min(v0.y, std::min(v1.y, v2.y)) - 0.5f))) };
+			const int maxX{ std::min(m_Resolution - 1, int(floorf(std::max(v0.x, std::max(v1.x, v2.x)) - 0.5f))) };
+			const int maxY{ std::min(m_Resolution - 1, int(floorf(std::max(v0.y, std::max(v1.y, v2.y)) - 0.5f))) };
+			if (minX > maxX || minY > maxY)
+				continue;
+
+			//edge functions and the depth are planes in x and y, a step to the right is an add
+			struct Edge
+			{
+				float a{}; //per x
+				float b{}; //per y
+				float c{};
+				float At(float x, float y) const { return a * x + b * y + c; }
+			};
+			const auto makeEdge{ [](const Vector3& from, const Vector3& to)
+				{
+					return Edge{ from.y - to.y, to.x - from.x, from.x * to.y - from.y * to.x };
+				} };
+			const Edge edges[3]{ makeEdge(v1, v2), makeEdge(v2, v0), makeEdge(v0, v1) };
+
+			const float invArea{ 1.f / area };
+			const Edge depth{
+				(edges[0].a * v0.z + edges[1].a * v1.z + edges[2].a * v2.z) * invArea,
+				(edges[0].b * v0.z + edges[1].b * v1.z + edges[2].b * v2.z) * invArea,
+				(edges[0].c * v0.z + edges[1].c * v1.z + edges[2].c * v2.z) * invArea
+			};
+
+			//the blocks of 4 start on a multiple of 4, the resolution is one too, so they never leave the row
+			const int startX{ minX & ~3 };
+			const __m128 edgeSteps[3]{ _mm_set1_ps(4.f * edges[0].a), _mm_set1_ps(4.f * edges[1].a), _mm_set1_ps(4.f * edges[2].a) };
+			const __m128 depthStep{ _mm_set1_ps(4.f * depth.a) };
+
+			for (int y{ minY }; y <= maxY; ++y)
+			{
+				const float pixelX{ startX + 0.5f };
+				const float pixelY{ y + 0.5f };
+
+				__m128 edgeValues[3]{};
+				for (int edgeIdx{ 0 }; edgeIdx < 3; ++edgeIdx)
+					edgeValues[edgeIdx] = _mm_add_ps(_mm_set1_ps(edges[edgeIdx].At(pixelX, pixelY)), _mm_mul_ps(laneOffsets, _mm_set1_ps(edges[edgeIdx].a)));
+				__m128 depths{ _mm_add_ps(_mm_set1_ps(depth.At(pixelX, pixelY)), _mm_mul_ps(laneOffsets, _mm_set1_ps(depth.a))) };
+
+				float* pRow{ m_Depth.data() + size_t(y) * m_Resolution };
+				for (int x{ startX }; x <= maxX; x += 4)
+				{
+					const __m128 bufferDepths{ _mm_loadu_ps(pRow + x) };
+					__m128 mask{ _mm_and_ps(_mm_cmpge_ps(edgeValues[0], zero), _mm_cmpge_ps(edgeValues[1], zero)) };
+					mask = _mm_and_ps(mask, _mm_cmpge_ps(edgeValues[2], zero));
+					mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmplt_ps(depths, bufferDepths), _mm_cmpge_ps(depths, zero)));
+
+					if (_mm_movemask_ps(mask) != 0)
+						_mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(mask, depths), _mm_andnot_ps(mask, bufferDepths)));
+
+					for (int edgeIdx{ 0 }; edgeIdx < 3; ++edgeIdx)
+						edgeValues[edgeIdx] = _mm_add_ps(edgeValues[edgeIdx], edgeSteps[edgeIdx]);
+					depths = _mm_add_ps(depths, depthStep);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+#include "DataTypes.h"
+#include "Math.h"
+
+namespace dae
+{
+	//the depth of the scene as the directional light sees it, the shading tests against it to find what is in shadow
+	//it has a depth-only rasterizer of its own: no varyings, no quads, 4 pixels of a row per sse compare
+	class ShadowMap final
+	{
+	public:
+		explicit ShadowMap(int resolution);
+		~ShadowMap() = default;
+
+		ShadowMap(const ShadowMap&) = delete;
+		ShadowMap(ShadowMap&&) noexcept = delete;
+		ShadowMap& operator=(const ShadowMap&) = delete;
+		ShadowMap& operator=(ShadowMap&&) noexcept = delete;
+
+		//texels along each side, rounded up to a multiple of 4, the map is drawn again on the next frame
+		void SetResolution(int resolution);
+		int GetResolution() const { return m_Resolution; }
+
+		//the map is drawn every updateInterval frames, 0 keeps it until Invalidate (static light and casters)
+		void SetUpdateInterval(int frames) { m_UpdateInterval = std::max(0, frames); }
+		int GetUpdateInterval() const { return m_UpdateInterval; }
+		void Invalidate() { m_IsValid = false; }
+
+		//counts the frame, true when the map has to be drawn again in it
+		bool NextFrame();
+
+		//fits the light volume around the bounds and clears the depth, the casters are drawn after it
+		void Begin(const Vector3& lightDirection, const BoundingBox& sceneBounds);
+		void DrawCaster(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const Matrix& worldMatrix);
+
+		//the volume the light would see after Begin with the same arguments, only the instances inside it cast shadows
+		//the map itself is left alone, casters can be picked while an older frame still reads it
+		Frustum GetFrustum(const Vector3& lightDirection, const BoundingBox& sceneBounds) const
+		{
+			float texelSize{};
+			return Frustum::FromMatrix(FitLightVolume(lightDirection, sceneBounds, texelSize));
+		}
+
+		//0 in shadow, 1 lit, a 3x3 tent filter (pcf) over 4x4 depth compares in between
+		//the lookup is pushed off the surface along the normal so it does not shadow itself
+		float GetVisibility(const Vector3& worldPosition, const Vector3& normal) const
+		{
+			const Vector3 position{ m_LightViewProjection.TransformPoint(worldPosition + normal * m_NormalOffset) };
+			const float u{ (position.x + 1.f) * 0.5f * m_Resolution - 0.5f };
+			const float v{ (1.f - position.y) * 0.5f * m_Resolution - 0.5f };
+			const float depth{ position.z - depthBias };
+
+			const float floorU{ floorf(u) };
+			const float floorV{ floorf(v) };
+			const float fractionU{ u - floorU };
+			const float fractionV{ v - floorV };
+			const float weightsU[4]{ 1.f - fractionU, 1.f, 1.f, fractionU };
+			const float weightsV[4]{ 1.f - fractionV, 1.f, 1.f, fractionV };
+
+			float visibility{};
+			for (int j{ 0 }; j < 4; ++j)
+			{
+				const int y{ std::clamp(int(floorV) - 1 + j, 0, m_Resolution - 1) };
+				const float* pRow{ m_Depth.data() + size_t(y) * m_Resolution };
+
+				float rowVisibility{};
+				for (int i{ 0 }; i < 4; ++i)
+				{
+					const int x{ std::clamp(int(floorU) - 1 + i, 0, m_Resolution - 1) };
+					rowVisibility += depth <= pRow[x] ? weightsU[i] : 0.f;
+				}
+				visibility += rowVisibility * weightsV[j];
+			}
+			return visibility * (1.f / 9.f);
+		}
+
+		const float* GetDepth() const { return m_Depth.data(); }
+
+	private:
+		static constexpr float depthBias{ 0.002f }; //of the depth range of the light volume
+
+		int m_Resolution{};
+		int m_UpdateInterval{ 1 };
+		int m_FramesSinceUpdate{};
+		bool m_IsValid{ false };
+
+		Matrix m_LightViewProjection{};
+		float m_NormalOffset{}; //world units, 1.5 texels
+
+		std::vector<float> m_Depth{}; //1 where nothing was drawn, the far end of the light volume
+		std::vector<Vector3> m_Positions{}; //the vertices of the last caster in raster space
+
+		Matrix FitLightVolume(const Vector3& lightDirection, const BoundingBox& sceneBounds, float& texelSize) const;
+	};
+}
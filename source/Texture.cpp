@@ -1,29 +1,238 @@
 #include "Texture.h"
 #include "Vector2.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <SDL_image.h>
 
 namespace dae
 {
-	Texture::Texture(SDL_Surface* pSurface) :
-		m_pSurface{ pSurface },
-		m_pSurfacePixels{ (uint32_t*)pSurface->pixels }
+	namespace
 	{
+		//byte -> [0, 1], replaces three divisions per sample
+		constexpr std::array<float, 256> g_UnormToFloat{ []()
+			{
+				std::array<float, 256> table{};
+				for (int i{ 0 }; i < 256; ++i)
+					table[i] = i / 255.f;
+				return table;
+			}() };
+
+		ColorRGB Unpack(uint32_t texel)
+		{
+			return { g_UnormToFloat[texel & 0xFF], g_UnormToFloat[(texel >> 8) & 0xFF], g_UnormToFloat[(texel >> 16) & 0xFF] };
+		}
+
+		void UnpackQuad(const uint32_t (&texels)[4], __m128 (&rgb)[3])
+		{
+			const __m128i packed{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels)) };
+			rgb[0] = Sampling::UnpackChannel(packed, 0);
+			rgb[1] = Sampling::UnpackChannel(packed, 8);
+			rgb[2] = Sampling::UnpackChannel(packed, 16);
+		}
+	}
+
+	Texture::Texture(SDL_Surface* pSurface, TextureLayout layout, TextureFormat format) :
+		m_Width{ pSurface->w },
+		m_Height{ pSurface->h },
+		m_Layout{ layout },
+		m_Texels(size_t(pSurface->w) * pSurface->h)
+	{
+		//the top level is decoded straight into m_Texels, BuildMipChain grows the storage afterwards
+		//unpack once with whatever format SDL gave us, so Sample never has to look at it again
+		SDL_LockSurface(pSurface);
+		const uint8_t* pRow{ static_cast<const uint8_t*>(pSurface->pixels) };
+		const int bytesPerPixel{ pSurface->format->BytesPerPixel };
+
+		for (int y{ 0 }; y < m_Height; ++y, pRow += pSurface->pitch)
+		{
+			for (int x{ 0 }; x < m_Width; ++x)
+			{
+				Uint32 pixel{};
+				std::memcpy(&pixel, pRow + x * bytesPerPixel, bytesPerPixel);
+
+				SDL_Color color{};
+				SDL_GetRGBA(pixel, pSurface->format, &color.r, &color.g, &color.b, &color.a);
+				m_Texels[x + y * m_Width] = uint32_t(color.r) | uint32_t(color.g) << 8 | uint32_t(color.b) << 16 | uint32_t(color.a) << 24;
+			}
+		}
+		SDL_UnlockSurface(pSurface);
+		SDL_FreeSurface(pSurface);
+
+		//the chain is built on the linear layout and reordered once at the end
+		m_Layout = TextureLayout::linear;
+		BuildMipChain();
+
+		if (format != TextureFormat::rgba8)
+		{
+			m_Format = format;
+			Compress();
+		}
+		else if (layout == TextureLayout::tiled)
+			ConvertToTiled();
+	}
+
+	void Texture::BuildMipChain()
+	{
+		//count the levels first so the texel storage is only allocated once
+		size_t texelCount{};
+		for (int width{ m_Width }, height{ m_Height };; width = std::max(1, width / 2), height = std::max(1, height / 2))
+		{
+			m_MipLevels.push_back({ width, height, texelCount });
+			texelCount += size_t(width) * height;
+			if (width == 1 && height == 1)
+				break;
+		}
+		m_Texels.resize(texelCount);
+
+		//box filter every level down from the previous one
+		for (size_t mipIdx{ 1 }; mipIdx < m_MipLevels.size(); ++mipIdx)
+		{
+			const MipLevel& source{ m_MipLevels[mipIdx - 1] };
+			const MipLevel& target{ m_MipLevels[mipIdx] };
+			const uint32_t* pSource{ &m_Texels[source.offset] };
+			uint32_t* pTarget{ &m_Texels[target.offset] };
+
+			for (int y{ 0 }; y < target.height; ++y)
+			{
+				const int y0{ std::min(2 * y, source.height - 1) };
+				const int y1{ std::min(2 * y + 1, source.height - 1) };
+				for (int x{ 0 }; x < target.width; ++x)
+				{
+					const int x0{ std::min(2 * x, source.width - 1) };
+					const int x1{ std::min(2 * x + 1, source.width - 1) };
+					pTarget[x + y * target.width] = Sampling::Average(
+						pSource[x0 + y0 * source.width], pSource[x1 + y0 * source.width],
+						pSource[x0 + y1 * source.width], pSource[x1 + y1 * source.width]);
+				}
+			}
+		}
+	}
+
+	void Texture::ConvertToTiled()
+	{
+		TexelBuffer tiled{};
+		std::vector<MipLevel> tiledLevels{};
+
+		//pad every level up to whole 4x4 tiles, the padding repeats the edge texels
+		size_t texelCount{};
+		for (const MipLevel& mip : m_MipLevels)
+		{
+			const int tilesPerRow{ (mip.width + 3) / 4 };
+			const int tileRows{ (mip.height + 3) / 4 };
+			tiledLevels.push_back({ mip.width, mip.height, texelCount, tilesPerRow });
+			texelCount += size_t(tilesPerRow) * tileRows * 16;
+		}
+		tiled.resize(texelCount);
+
+		for (size_t mipIdx{ 0 }; mipIdx < m_MipLevels.size(); ++mipIdx)
+		{
+			const MipLevel& linearMip{ m_MipLevels[mipIdx] };
+			const MipLevel& tiledMip{ tiledLevels[mipIdx] };
+			const int paddedWidth{ tiledMip.tilesPerRow * 4 };
+			const int paddedHeight{ ((linearMip.height + 3) / 4) * 4 };
+
+			for (int y{ 0 }; y < paddedHeight; ++y)
+			{
+				for (int x{ 0 }; x < paddedWidth; ++x)
+				{
+					const int sourceX{ std::min(x, linearMip.width - 1) };
+					const int sourceY{ std::min(y, linearMip.height - 1) };
+					const size_t tile{ size_t(y >> 2) * tiledMip.tilesPerRow + (x >> 2) };
+					tiled[tiledMip.offset + tile * 16 + ((y & 3) << 2) + (x & 3)] = m_Texels[linearMip.offset + sourceX + size_t(sourceY) * linearMip.width];
+				}
+			}
+		}
+
+		m_Texels = std::move(tiled);
+		m_MipLevels = std::move(tiledLevels);
+		m_Layout = TextureLayout::tiled;
 	}
 
-	Texture::~Texture()
+	void Texture::Compress()
 	{
-		if (m_pSurface)
+		std::vector<MipLevel> blockLevels{};
+		const size_t blocksPerTile{ m_Format == TextureFormat::bc5 ? 2u : 1u };
+
+		size_t blockCount{};
+		for (const MipLevel& mip : m_MipLevels)
 		{
-			SDL_FreeSurface(m_pSurface);
-			m_pSurface = nullptr;
+			const int blocksPerRow{ (mip.width + 3) / 4 };
+			const int blockRows{ (mip.height + 3) / 4 };
+			blockLevels.push_back({ mip.width, mip.height, blockCount, blocksPerRow });
+			blockCount += size_t(blocksPerRow) * blockRows * blocksPerTile;
 		}
+		m_Blocks.resize(blockCount);
+
+		for (size_t mipIdx{ 0 }; mipIdx < m_MipLevels.size(); ++mipIdx)
+		{
+			const MipLevel& linearMip{ m_MipLevels[mipIdx] };
+			const MipLevel& blockMip{ blockLevels[mipIdx] };
+			const int blockRows{ (linearMip.height + 3) / 4 };
+
+			for (int blockY{ 0 }; blockY < blockRows; ++blockY)
+			{
+				for (int blockX{ 0 }; blockX < blockMip.tilesPerRow; ++blockX)
+				{
+					//blocks hanging over the edge repeat the edge texels
+					uint32_t texels[16]{};
+					uint8_t reds[16]{};
+					uint8_t greens[16]{};
+					for (int texelIdx{ 0 }; texelIdx < 16; ++texelIdx)
+					{
+						const int x{ std::min(blockX * 4 + (texelIdx & 3), linearMip.width - 1) };
+						const int y{ std::min(blockY * 4 + (texelIdx >> 2), linearMip.height - 1) };
+						texels[texelIdx] = m_Texels[linearMip.offset + x + size_t(y) * linearMip.width];
+						reds[texelIdx] = uint8_t(texels[texelIdx] & 0xFF);
+						greens[texelIdx] = uint8_t((texels[texelIdx] >> 8) & 0xFF);
+					}
+
+					const size_t block{ blockMip.offset + (size_t(blockY) * blockMip.tilesPerRow + blockX) * blocksPerTile };
+					switch (m_Format)
+					{
+					case TextureFormat::bc1:
+						m_Blocks[block] = BlockCompression::EncodeBC1(texels);
+						break;
+					case TextureFormat::bc4:
+						m_Blocks[block] = BlockCompression::EncodeBC4(reds);
+						break;
+					case TextureFormat::bc5:
+						m_Blocks[block] = BlockCompression::EncodeBC4(reds);
+						m_Blocks[block + 1] = BlockCompression::EncodeBC4(greens);
+						break;
+					default:
+						break;
+					}
+				}
+			}
+		}
+
+		m_Texels.clear();
+		m_Texels.shrink_to_fit();
+		m_MipLevels = std::move(blockLevels);
 	}
 
-	Texture* Texture::LoadFromFile(const std::string& path)
+	Texture* Texture::LoadFromFile(const std::string& path, TextureLayout layout, TextureFormat format)
 	{
 		//Load SDL_Surface using IMG_LOAD
 		//Create & Return a new Texture Object (using SDL_Surface)
-		Texture* pTexture{ new Texture(IMG_Load(path.c_str())) };
+		SDL_Surface* pSurface{ IMG_Load(path.c_str()) };
+		if (!pSurface)
+			return nullptr;
+
+		Texture* pTexture{ new Texture(pSurface, layout, format) };
+		return pTexture;
+	}
+
+	Texture* Texture::CreateSolid(uint32_t texel)
+	{
+		//a single texel is its own mip chain, nothing to decode or filter
+		Texture* pTexture{ new Texture() };
+		pTexture->m_Width = 1;
+		pTexture->m_Height = 1;
+		pTexture->m_Texels.push_back(texel);
+		pTexture->m_MipLevels.push_back({ 1, 1, 0 });
 		return pTexture;
 	}
 
@@ -32,14 +241,126 @@ namespace dae
 		//Sample the correct texel for the given uv
 		
 		//uv is between [0,1] -> convert to [0, width] and [0, height]
-		int x{ int(uv.x * m_pSurface->w) };
-		int y{ int(uv.y * m_pSurface->h) };
+		int x{ int(uv.x * m_Width) };
+		int y{ int(uv.y * m_Height) };
+
+		return Unpack(FetchTexel(m_MipLevels[0], x, y));
+	}
+
+	ColorRGB Texture::Sample(const SamplerState& sampler, const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy) const
+	{
+		switch (sampler.filter)
+		{
+		case TextureFilter::point:
+			return SamplePoint(uv, 0, sampler.addressMode);
+		case TextureFilter::bilinear:
+			return SampleBilinear(uv, 0, sampler.addressMode);
+		case TextureFilter::trilinear:
+		default:
+			break;
+		}
+
+		const float lod{ Sampling::GetMipLevel(uvDdx, uvDdy, m_Width, m_Height, GetMipCount()) };
+		const int mipIdx{ int(lod) };
+		const float blend{ lod - float(mipIdx) };
+		if (blend == 0.f)
+			return SampleBilinear(uv, mipIdx, sampler.addressMode);
+
+		return ColorRGB::Lerp(SampleBilinear(uv, mipIdx, sampler.addressMode), SampleBilinear(uv, mipIdx + 1, sampler.addressMode), blend);
+	}
+
+	void Texture::SampleQuad(const SamplerState& sampler, const Vector2 (&uvs)[4], const Vector2& uvDdx, const Vector2& uvDdy, ColorRGB (&colors)[4]) const
+	{
+		if (sampler.filter == TextureFilter::point)
+		{
+			for (int lane{ 0 }; lane < 4; ++lane)
+				colors[lane] = SamplePoint(uvs[lane], 0, sampler.addressMode);
+			return;
+		}
+
+		const __m128 u{ _mm_setr_ps(uvs[0].x, uvs[1].x, uvs[2].x, uvs[3].x) };
+		const __m128 v{ _mm_setr_ps(uvs[0].y, uvs[1].y, uvs[2].y, uvs[3].y) };
+
+		float lod{ 0.f };
+		if (sampler.filter == TextureFilter::trilinear)
+			lod = Sampling::GetMipLevel(uvDdx, uvDdy, m_Width, m_Height, GetMipCount());
+
+		const int mipIdx{ int(lod) };
+		const float blend{ lod - float(mipIdx) };
+
+		__m128 rgb[3]{};
+		SampleBilinearQuad(u, v, mipIdx, sampler.addressMode, rgb);
 
-		Uint32 pixelIdx = m_pSurfacePixels[x + (y * m_pSurface->w)];
+		if (blend > 0.f)
+		{
+			__m128 nextRgb[3]{};
+			SampleBilinearQuad(u, v, mipIdx + 1, sampler.addressMode, nextRgb);
+
+			const __m128 blendV{ _mm_set1_ps(blend) };
+			for (int channel{ 0 }; channel < 3; ++channel)
+				rgb[channel] = _mm_add_ps(rgb[channel], _mm_mul_ps(_mm_sub_ps(nextRgb[channel], rgb[channel]), blendV));
+		}
+
+		alignas(16) float channels[3][4]{};
+		for (int channel{ 0 }; channel < 3; ++channel)
+			_mm_store_ps(channels[channel], rgb[channel]);
+
+		for (int lane{ 0 }; lane < 4; ++lane)
+			colors[lane] = { channels[0][lane], channels[1][lane], channels[2][lane] };
+	}
+
+	ColorRGB Texture::SamplePoint(const Vector2& uv, int mipIdx, TextureAddressMode addressMode) const
+	{
+		const MipLevel& mip{ m_MipLevels[mipIdx] };
+		const int x{ Sampling::AddressCoordinate(int(std::floor(uv.x * mip.width)), mip.width, addressMode) };
+		const int y{ Sampling::AddressCoordinate(int(std::floor(uv.y * mip.height)), mip.height, addressMode) };
+		return Unpack(FetchTexel(mip, x, y));
+	}
+
+	ColorRGB Texture::SampleBilinear(const Vector2& uv, int mipIdx, TextureAddressMode addressMode) const
+	{
+		const MipLevel& mip{ m_MipLevels[mipIdx] };
 
-		SDL_Color sdl_rgb;
-		SDL_GetRGB(pixelIdx, m_pSurface->format, &sdl_rgb.r, &sdl_rgb.g, &sdl_rgb.b);
-		ColorRGB rgb{ sdl_rgb.r / 255.f, sdl_rgb.g / 255.f, sdl_rgb.b / 255.f };
-		return rgb;
+		//texel centers sit at half texel offsets
+		const float x{ uv.x * mip.width - 0.5f };
+		const float y{ uv.y * mip.height - 0.5f };
+		const float xFloor{ std::floor(x) };
+		const float yFloor{ std::floor(y) };
+		const float fx{ x - xFloor };
+		const float fy{ y - yFloor };
+
+		const int x0{ Sampling::AddressCoordinate(int(xFloor), mip.width, addressMode) };
+		const int y0{ Sampling::AddressCoordinate(int(yFloor), mip.height, addressMode) };
+		const int x1{ Sampling::AddressCoordinate(int(xFloor) + 1, mip.width, addressMode) };
+		const int y1{ Sampling::AddressCoordinate(int(yFloor) + 1, mip.height, addressMode) };
+
+		const ColorRGB top{ ColorRGB::Lerp(Unpack(FetchTexel(mip, x0, y0)), Unpack(FetchTexel(mip, x1, y0)), fx) };
+		const ColorRGB bottom{ ColorRGB::Lerp(Unpack(FetchTexel(mip, x0, y1)), Unpack(FetchTexel(mip, x1, y1)), fx) };
+		return ColorRGB::Lerp(top, bottom, fy);
+	}
+
+	void Texture::SampleBilinearQuad(__m128 u, __m128 v, int mipIdx, TextureAddressMode addressMode, __m128 (&rgb)[3]) const
+	{
+		const MipLevel& mip{ m_MipLevels[mipIdx] };
+		const Sampling::BilinearFootprint footprint{ Sampling::GetBilinearFootprint(u, v, mip.width, mip.height, addressMode) };
+
+		//SSE2 has no gather, the 16 loads are scalar and everything after them is 4 wide
+		uint32_t texels[4][4]{};
+		for (int lane{ 0 }; lane < 4; ++lane)
+		{
+			texels[0][lane] = FetchTexel(mip, footprint.x0[lane], footprint.y0[lane]);
+			texels[1][lane] = FetchTexel(mip, footprint.x1[lane], footprint.y0[lane]);
+			texels[2][lane] = FetchTexel(mip, footprint.x0[lane], footprint.y1[lane]);
+			texels[3][lane] = FetchTexel(mip, footprint.x1[lane], footprint.y1[lane]);
+		}
+
+		rgb[0] = rgb[1] = rgb[2] = _mm_setzero_ps();
+		for (int corner{ 0 }; corner < 4; ++corner)
+		{
+			__m128 cornerRgb[3]{};
+			UnpackQuad(texels[corner], cornerRgb);
+			for (int channel{ 0 }; channel < 3; ++channel)
+				rgb[channel] = _mm_add_ps(rgb[channel], _mm_mul_ps(cornerRgb[channel], footprint.weights[corner]));
+		}
 	}
-}
\ No newline at end of file
+}
@@ -1,24 +1,132 @@
 #pragma once
+#include <memory>
 #include <SDL_surface.h>
 #include <string>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "BlockCompression.h"
 #include "ColorRGB.h"
+#include "Sampler.h"
 
 namespace dae
 {
 	struct Vector2;
 
+	enum class TextureLayout
+	{
+		linear, //row by row, like the SDL surface
+		tiled   //4x4 blocks of texels stored together, neighbours in 2D are neighbours in memory
+	};
+
+	//compressed formats are encoded once at load time and decoded per texel fetch
+	enum class TextureFormat
+	{
+		rgba8,
+		bc1, //rgb, 4 bits per texel
+		bc4, //red only, sampled as grey, 4 bits per texel
+		bc5  //red and green, blue is 0, 8 bits per texel
+	};
+
 	class Texture
 	{
 	public:
-		~Texture();
+		~Texture() = default;
+
+		//block compressed textures are always stored as 4x4 blocks, the layout only applies to rgba8
+		static Texture* LoadFromFile(const std::string& path, TextureLayout layout = TextureLayout::linear, TextureFormat format = TextureFormat::rgba8);
+		//1x1 texture of a single RGBA8 texel, red in the lowest byte, stands in for a file that failed to load
+		static Texture* CreateSolid(uint32_t texel);
 
-		static Texture* LoadFromFile(const std::string& path);
+		//nearest texel of the top level
 		ColorRGB Sample(const Vector2& uv) const;
+		//the mip level (trilinear only) is picked from the screen space derivatives of uv
+		ColorRGB Sample(const SamplerState& sampler, const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy) const;
+		//the 4 pixels of a 2x2 quad share their derivatives, so they share the mip level and are filtered together in SIMD
+		void SampleQuad(const SamplerState& sampler, const Vector2 (&uvs)[4], const Vector2& uvDdx, const Vector2& uvDdy, ColorRGB (&colors)[4]) const;
+
+		int GetWidth() const { return m_Width; }
+		int GetHeight() const { return m_Height; }
+		int GetMipCount() const { return int(m_MipLevels.size()); }
+		TextureLayout GetLayout() const { return m_Layout; }
+		TextureFormat GetFormat() const { return m_Format; }
+		//all mip levels
+		size_t GetSizeInBytes() const { return m_Texels.size() * sizeof(uint32_t) + m_Blocks.size() * sizeof(uint64_t); }
+		//RGBA8 texel of the top level, decoded if needed, for tools that repack the texture
+		uint32_t GetTexel(int x, int y) const { return FetchTexel(m_MipLevels[0], x, y); }
 
 	private:
-		Texture(SDL_Surface* pSurface);
+		//decodes the surface into the internal layout, the surface itself is not kept
+		Texture(SDL_Surface* pSurface, TextureLayout layout, TextureFormat format);
+		Texture() = default;
+
+		int m_Width{};
+		int m_Height{};
+		TextureLayout m_Layout{ TextureLayout::linear };
+		TextureFormat m_Format{ TextureFormat::rgba8 };
 
-		SDL_Surface* m_pSurface{ nullptr };
-		uint32_t* m_pSurfacePixels{ nullptr };
+		struct MipLevel
+		{
+			int width{};
+			int height{};
+			size_t offset{}; //first texel of this level in m_Texels, first block in m_Blocks when compressed
+			int tilesPerRow{}; //tiled layout and compressed formats only, rows are padded to whole tiles
+		};
+
+		//RGBA8, red in the lowest byte, independent of the format the file was stored in
+		//all mip levels back to back, level 0 first
+		//64 byte aligned, in the tiled layout every level starts on a whole tile so each 4x4 tile fills exactly one cache line
+		using TexelBuffer = std::vector<uint32_t, AlignedAllocator<uint32_t, 64>>;
+		TexelBuffer m_Texels{};
+		std::vector<MipLevel> m_MipLevels{};
+
+		//compressed formats only, m_Texels is empty then
+		std::vector<uint64_t> m_Blocks{};
+
+		void BuildMipChain();
+		void ConvertToTiled();
+		void Compress();
+
+		size_t GetTexelIndex(const MipLevel& mip, int x, int y) const
+		{
+			if (m_Layout == TextureLayout::linear)
+				return mip.offset + x + size_t(y) * mip.width;
+
+			const size_t tile{ size_t(y >> 2) * mip.tilesPerRow + (x >> 2) };
+			return mip.offset + tile * 16 + ((y & 3) << 2) + (x & 3);
+		}
+
+		//RGBA8 whatever the storage is
+		uint32_t FetchTexel(const MipLevel& mip, int x, int y) const
+		{
+			if (m_Format == TextureFormat::rgba8)
+				return m_Texels[GetTexelIndex(mip, x, y)];
+
+			const size_t block{ size_t(y >> 2) * mip.tilesPerRow + (x >> 2) };
+			const int texelIdx{ ((y & 3) << 2) + (x & 3) };
+			switch (m_Format)
+			{
+			case TextureFormat::bc1:
+				return BlockCompression::DecodeBC1(m_Blocks[mip.offset + block], texelIdx);
+			case TextureFormat::bc4:
+			{
+				const uint32_t value{ BlockCompression::DecodeBC4(m_Blocks[mip.offset + block], texelIdx) };
+				return 0xFF000000 | value << 16 | value << 8 | value;
+			}
+			case TextureFormat::bc5:
+			default:
+			{
+				const uint32_t red{ BlockCompression::DecodeBC4(m_Blocks[mip.offset + 2 * block], texelIdx) };
+				const uint32_t green{ BlockCompression::DecodeBC4(m_Blocks[mip.offset + 2 * block + 1], texelIdx) };
+				return 0xFF000000 | green << 8 | red;
+			}
+			}
+		}
+
+		ColorRGB SamplePoint(const Vector2& uv, int mipIdx, TextureAddressMode addressMode) const;
+		ColorRGB SampleBilinear(const Vector2& uv, int mipIdx, TextureAddressMode addressMode) const;
+		//r, g and b of the 4 lanes
+		void SampleBilinearQuad(__m128 u, __m128 v, int mipIdx, TextureAddressMode addressMode, __m128 (&rgb)[3]) const;
 	};
-}
\ No newline at end of file
+
+	using TextureHandle = std::shared_ptr<const Texture>;
+}
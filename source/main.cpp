@@ -63,6 +63,20 @@ int main(int argc, char* args[])
 			case SDL_KEYUP:
 				if (e.key.keysym.scancode == SDL_SCANCODE_X)
 					takeScreenshot = true;
+				if (e.key.keysym.scancode == SDL_SCANCODE_T)
+					pRenderer->CycleToneMapping();
+				if (e.key.keysym.scancode == SDL_SCANCODE_R)
+					pRenderer->CycleDynamicResolution();
+				if (e.key.keysym.scancode == SDL_SCANCODE_V)
+					pRenderer->CycleShadingRate();
+				if (e.key.keysym.scancode == SDL_SCANCODE_M)
+					pRenderer->ToggleMSAA();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F1)
+					pRenderer->CycleShadowMapResolution();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F2)
+					pRenderer->CycleShadows();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F3)
+					pRenderer->ToggleDeferredShading();
 				if (e.key.keysym.scancode == SDL_SCANCODE_F4)
 					pRenderer->CycleTexture();
 				if (e.key.keysym.scancode == SDL_SCANCODE_F5)
@@ -71,6 +85,16 @@ int main(int argc, char* args[])
 					pRenderer->ToggleNormalMap();
 				if (e.key.keysym.scancode == SDL_SCANCODE_F7)
 					pRenderer->CycleShadingMode();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F8)
+					pRenderer->CycleLODErrorBudget();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F9)
+					pRenderer->CycleTextureFilter();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F10)
+					pRenderer->PrintAssetMemory();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F11)
+					pRenderer->ToggleLocalLights();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F12)
+					pRenderer->CycleRenderAhead();
 
 				break;
 			}